@@ -0,0 +1,201 @@
+#include "alloc.h"
+
+#ifdef RANDO_ALLOC_TRACKING
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+// Every allocation has this in front of it, so delete knows how big it was and who made it (16 bytes keeps the alignment)
+struct AllocHeader {
+	uint64_t size;
+	uint32_t phase;
+	uint32_t unused;
+};
+
+struct AllocPhase {
+	std::atomic<const char *> name{nullptr};
+	std::atomic<uint64_t> bytes{0};				// Since the last reset
+	std::atomic<uint64_t> count{0};
+	std::atomic<uint64_t> peak{0};
+	std::atomic<uint64_t> live{0};				// Made by this phase and not deleted yet (ever, not just since the reset)
+	std::atomic<uint64_t> liveCount{0};
+};
+
+// Phase 0 is everything outside of any phase
+static AllocPhase gAllocPhases[kAllocMaxPhases];
+static std::atomic<int> gAllocNumPhases{1};
+static std::atomic<uint64_t> gAllocTotal{0};
+static std::mutex gAllocMutex;
+static thread_local int tAllocPhase = 0;
+
+static int findPhase(const char *name) {
+	// Almost always the same literal as last time, so the pointer is enough
+	int numPhases = gAllocNumPhases.load(std::memory_order_acquire);
+	for (int i = 1; i < numPhases; i++) {
+		if (gAllocPhases[i].name.load(std::memory_order_relaxed) == name) {
+			return i;
+		}
+	}
+
+	// But the same name in another file can be a different pointer
+	std::lock_guard<std::mutex> lock(gAllocMutex);
+	numPhases = gAllocNumPhases.load(std::memory_order_relaxed);
+	for (int i = 1; i < numPhases; i++) {
+		if (strcmp(gAllocPhases[i].name.load(std::memory_order_relaxed), name) == 0) {
+			return i;
+		}
+	}
+
+	if (numPhases == kAllocMaxPhases) {
+		return 0;
+	}
+
+	gAllocPhases[numPhases].name.store(name, std::memory_order_relaxed);
+	gAllocNumPhases.store(numPhases + 1, std::memory_order_release);
+	return numPhases;
+}
+
+int allocEnter(const char *name) {
+	int previous = tAllocPhase;
+	tAllocPhase = findPhase(name);
+	return previous;
+}
+
+void allocLeave(int previous) {
+	tAllocPhase = previous;
+}
+
+void allocReset() {
+	int numPhases = gAllocNumPhases.load(std::memory_order_acquire);
+	for (int i = 0; i < numPhases; i++) {
+		AllocPhase &phase = gAllocPhases[i];
+		phase.bytes = 0;
+		phase.count = 0;
+		phase.peak = phase.live.load();
+	}
+}
+
+uint64_t allocTotalCount() {
+	return gAllocTotal.load(std::memory_order_relaxed);
+}
+
+std::string allocReport() {
+	// Everything gets read first, since making the report allocates too
+	struct Row {
+		const char *name;
+		uint64_t bytes, count, peak, live, liveCount;
+	};
+	Row rows[kAllocMaxPhases];
+	int numPhases = gAllocNumPhases.load(std::memory_order_acquire);
+	for (int i = 0; i < numPhases; i++) {
+		AllocPhase &phase = gAllocPhases[i];
+		const char *name = phase.name.load(std::memory_order_relaxed);
+		rows[i] = {(name != nullptr) ? name : "(no phase)", phase.bytes.load(), phase.count.load(), phase.peak.load(), phase.live.load(), phase.liveCount.load()};
+	}
+
+	std::ostringstream report;
+	report << std::left << std::setw(28) << "phase" << std::right << std::setw(14) << "bytes" << std::setw(10) << "allocs"
+		   << std::setw(14) << "peak" << std::setw(14) << "live bytes" << std::setw(12) << "live allocs" << '\n';
+	for (int i = 0; i < numPhases; i++) {
+		const Row &row = rows[i];
+		if ((row.count == 0) && (row.liveCount == 0)) {
+			continue;
+		}
+		report << std::left << std::setw(28) << row.name << std::right << std::setw(14) << row.bytes << std::setw(10) << row.count
+			   << std::setw(14) << row.peak << std::setw(14) << row.live << std::setw(12) << row.liveCount << '\n';
+	}
+	return report.str();
+}
+
+/* The global new and delete
+ * Only the plain and nothrow ones, everything else
+ * (sized, aligned) ends up calling these anyway
+ */
+void *operator new(size_t size) {
+	AllocHeader *header = (AllocHeader *) malloc(sizeof(AllocHeader) + size);
+	if (header == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	int index = tAllocPhase;
+	header->size = size;
+	header->phase = index;
+
+	AllocPhase &phase = gAllocPhases[index];
+	phase.bytes.fetch_add(size, std::memory_order_relaxed);
+	phase.count.fetch_add(1, std::memory_order_relaxed);
+	phase.liveCount.fetch_add(1, std::memory_order_relaxed);
+	uint64_t live = phase.live.fetch_add(size, std::memory_order_relaxed) + size;
+	uint64_t peak = phase.peak.load(std::memory_order_relaxed);
+	while ((peak < live) && (phase.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed) == false)) {}
+
+	gAllocTotal.fetch_add(1, std::memory_order_relaxed);
+	return header + 1;
+}
+
+void *operator new[](size_t size) {
+	return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+	try {
+		return operator new(size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void *p) noexcept {
+	if (p == nullptr) {
+		return;
+	}
+
+	AllocHeader *header = (AllocHeader *) p - 1;
+	AllocPhase &phase = gAllocPhases[header->phase];
+	phase.live.fetch_sub(header->size, std::memory_order_relaxed);
+	phase.liveCount.fetch_sub(1, std::memory_order_relaxed);
+	free(header);
+}
+
+void operator delete[](void *p) noexcept {
+	operator delete(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+	operator delete(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+	operator delete(p);
+}
+
+#else
+
+int allocEnter(const char *) {
+	return 0;
+}
+
+void allocLeave(int) {
+}
+
+void allocReset() {
+}
+
+uint64_t allocTotalCount() {
+	return 0;
+}
+
+std::string allocReport() {
+	return "";
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef RANDO_ALLOC_H
+#define RANDO_ALLOC_H
+
+#include <cstdint>
+#include <string>
+
+/* Allocation tracking
+ * Built with -DRANDO_ALLOC_TRACKING (make TRACK_ALLOCS=1), every new and
+ * delete goes through here. Each allocation belongs to whichever trace
+ * scope (or phase) its thread was in when it was made, and each of those
+ * keeps how many bytes and allocations it made, how much of it was alive
+ * at once at most, and how much of it is still alive now. So anything
+ * still alive after a seed is done is either a cache or a leak, and the
+ * report says which part of the seed it came from.
+ *
+ * Without the define, none of this does anything.
+ */
+enum AllocValues {
+	kAllocMaxPhases = 128		// Anything past this gets put down as outside any phase
+};
+
+int allocEnter(const char *name);		// Makes name the phase for this thread, returning the one it was in before
+void allocLeave(int previous);			// Goes back to that phase
+void allocReset();						// Starts a new seed, so the totals and peaks start again (what's alive stays)
+uint64_t allocTotalCount();				// Every allocation made since the program started
+std::string allocReport();				// A table of every phase that did anything since the last reset, or still has something alive
+
+#endif
@@ -0,0 +1,403 @@
+// Project Base Randomizer
+// Bench
+#include "generator.h"
+#include "rom.h"
+#include "colour.h"
+#include "trace.h"
+#include "alloc.h"
+
+#include <wx/init.h>
+#include <wx/file.h>
+#include <wx/filename.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <new>
+
+/* Benchmarks
+ * Times the slow parts of making a seed, over the same seeds every time, so that
+ * two runs can be compared. Each one reports the average time per op, how many
+ * allocations each op made, and the time per op at the 50th, 90th and 99th
+ * percentile of its samples. With a baseline file, it also says how each one
+ * compares to the last saved run, and exits with 1 if anything got slower.
+ *
+ * bench [--rom <base rom>] [--baseline <file>] [--save] [--samples <n>] [--trace <file>] [--counters <file>]
+ *
+ * The logic benchmarks also add up the logic counters of every seed they ran,
+ * which get printed as averages per seed, and saved as CSV with --counters.
+ *
+ * Built with TRACK_ALLOCS=1, it finishes with the allocation report of everything
+ * it ran (with the timings slowed down by the tracking).
+ *
+ * Without a rom it uses a blank 4MB image, with the tileset palettes made fresh
+ * from the templates instead of read out of the rom.
+ */
+enum BenchValues {
+	kBenchRomSize	= 0x400000,
+	kBenchSamples	= 20,
+	kBenchTolerance	= 10,		// How much slower (as a percent) than the baseline counts as a regression
+	kBenchPalSlot	= 0x200		// Room for one compressed palette
+};
+
+// The seeds every run goes through, in this order
+static const long kBenchSeeds[] = {1, 2, 3, 58, 1234, 80085, 1000000, 2147483647};
+static const int kNumBenchSeeds = sizeof(kBenchSeeds) / sizeof(long);
+
+// Every allocation goes through here, so each benchmark can say how many it made
+#ifndef RANDO_ALLOC_TRACKING
+static std::atomic<uint64_t> gAllocations{0};
+
+void *operator new(size_t size) {
+	gAllocations.fetch_add(1, std::memory_order_relaxed);
+	void *p = malloc((size == 0) ? 1 : size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	free(p);
+}
+
+static uint64_t allocations() {
+	return gAllocations.load(std::memory_order_relaxed);
+}
+
+#else
+// Unless the allocation tracker already has them
+static uint64_t allocations() {
+	return allocTotalCount();
+}
+#endif
+
+struct BenchResult {
+	wxString name;
+	double ns = 0;				// The average time per op
+	double allocs = 0;			// And allocations per op
+	double p50 = 0;				// The time per op of the sample at each percentile
+	double p90 = 0;
+	double p99 = 0;
+};
+
+// The nearest rank, so with few samples p99 is just the slowest one
+static double percentile(const std::vector<double> &sorted, int p) {
+	size_t rank = ((sorted.size() * p) + 99) / 100;
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+static BenchResult measure(wxString name, int samples, int ops, std::function<void()> op) {
+	// Anything the generation code prints would just be timing the console, so that goes nowhere while we measure
+	std::streambuf *console = std::cout.rdbuf(nullptr);
+
+	// One untimed sample first, so anything that gets made the first time round (tables, caches) doesn't count
+	for (int i = 0; i < ops; i++) {
+		op();
+	}
+
+	std::vector<double> times;
+	times.reserve(samples);
+
+	uint64_t allocated = allocations();
+	for (int s = 0; s < samples; s++) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int i = 0; i < ops; i++) {
+			op();
+		}
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		times.push_back(elapsed.count() / ops);
+	}
+	allocated = allocations() - allocated;
+
+	std::cout.rdbuf(console);
+
+	BenchResult result;
+	result.name = name;
+	for (double t : times) {
+		result.ns += t;
+	}
+	result.ns /= samples;
+	result.allocs = (double) allocated / (samples * ops);
+
+	std::sort(times.begin(), times.end());
+	result.p50 = percentile(times, 50);
+	result.p90 = percentile(times, 90);
+	result.p99 = percentile(times, 99);
+	return result;
+}
+
+/* The baseline is one line per benchmark, with the name and
+ * then each number, all separated by tabs
+ */
+static std::vector<BenchResult> readBaseline(const std::string &path) {
+	std::vector<BenchResult> baseline;
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream fields(line);
+		std::string name;
+		BenchResult result;
+		if (std::getline(fields, name, '\t') && (fields >> result.ns >> result.allocs >> result.p50 >> result.p90 >> result.p99)) {
+			result.name = name;
+			baseline.push_back(result);
+		}
+	}
+	return baseline;
+}
+
+static void writeBaseline(const std::string &path, const std::vector<BenchResult> &results) {
+	std::ofstream file(path);
+	for (const BenchResult &result : results) {
+		file << result.name.ToStdString() << '\t' << result.ns << '\t' << result.allocs << '\t'
+			 << result.p50 << '\t' << result.p90 << '\t' << result.p99 << '\n';
+	}
+}
+
+/* Bench
+ * A generator with no window, that runs each part of
+ * making a seed over and over on its own
+ */
+class Bench : public Generator {
+public:
+	~Bench() {
+		if (_tempPath != "") {
+			wxRemoveFile(_tempPath);
+		}
+	}
+
+	bool load(wxString path);
+	void run(int samples, std::vector<BenchResult> &results, std::vector<std::pair<wxString, LogicCounters>> &counters);
+
+private:
+	wxString _tempPath = "";
+	bool _synthetic = false;
+	Palette128 _palettes[kNumTilesets];
+
+	void findPalettes();
+};
+
+bool Bench::load(wxString path) {
+	// Without a real rom, a blank one is enough, since everything here only writes to it
+	if (path == "") {
+		_tempPath = wxFileName::CreateTempFileName("pbbench");
+		std::vector<wxByte> image(kBenchRomSize, 0);
+		wxFile file(_tempPath, wxFile::write);
+		if ((file.IsOpened() == false) || (file.Write(image.data(), image.size()) != image.size())) {
+			std::cout << "couldn't make the synthetic rom at " << _tempPath << std::endl;
+			return false;
+		}
+		file.Close();
+
+		path = _tempPath;
+		_synthetic = true;
+
+	} else if (wxFile::Exists(path) == false) {
+		std::cout << "can't find the rom " << path << std::endl;
+		return false;
+	}
+
+	loadRom(path);
+	_settings.basePath = path;
+	findPalettes();
+	return true;
+}
+
+void Bench::findPalettes() {
+	// A real rom already has real tileset palettes in it
+	if (_synthetic == false) {
+		for (int t = 0; t < kNumTilesets; t++) {
+			const wxByte *entry = _rom->_dataBuffer + kAddrGfxPal + (t * 9);
+			_rom->decompressPalette(_palettes[t], Rom::snesToPc(entry[0] | (entry[1] << 8) | (entry[2] << 16)));
+		}
+
+	// And a blank one gets the same kind of palettes a seed would make
+	} else {
+		tilesetPalettes(_settings, Rng(kBenchSeeds[0]), _palettes);
+	}
+}
+
+void Bench::run(int samples, std::vector<BenchResult> &results, std::vector<std::pair<wxString, LogicCounters>> &counters) {
+	int next = 0;
+
+	// The logic under each of the difficulty presets
+	for (int d = 0; d < kNumDifficulties; d++) {
+		const DifficultyPreset &preset = kDifficultyPresets[d];
+		_settings.tricks = preset.tricks;
+		_settings.energyLow = preset.energyLow;
+		_settings.energyMed = preset.energyMed;
+		_settings.energyHigh = preset.energyHigh;
+
+		LogicTotals totals;
+		wxString name = wxString::Format("logic (%s)", preset.name);
+		results.push_back(measure(name, samples, 1, [&]() {
+			_settings.seed = kBenchSeeds[next++ % kNumBenchSeeds];
+			resetPlayer();
+			logic();
+			totals.add(_counters);
+			_log = "";
+		}));
+		counters.push_back(std::make_pair(name, totals.get()));
+	}
+
+	// Every tileset palette, from the templates through to being compressed into the rom
+	results.push_back(measure("makeNewTilesetPalettes", samples, 1, [&]() {
+		_settings.seed = kBenchSeeds[next++ % kNumBenchSeeds];
+		_rom->initFreeSpace(_settings.vanilla);
+		makeNewTilesetPalettes();
+	}));
+
+	// Each palette gets its own slot, so the decompression has them all to read back
+	_rom->initFreeSpace(_settings.vanilla);
+	long slots[kNumTilesets];
+	for (int t = 0; t < kNumTilesets; t++) {
+		slots[t] = _rom->allocate(kBenchPalSlot);
+	}
+
+	results.push_back(measure("compressPalette", samples, kNumTilesets, [&]() {
+		int t = next++ % kNumTilesets;
+		_rom->compressPalette(_palettes[t], slots[t]);
+	}));
+
+	Palette128 palette;
+	results.push_back(measure("decompressPalette", samples, kNumTilesets, [&]() {
+		_rom->decompressPalette(palette, slots[next++ % kNumTilesets]);
+	}));
+
+	// All of the font patches, one after another
+	wxByte *fonts[] = {_gfxFontBrail, _gfxFontUpsideDown, _gfxFontGalactic, _gfxFontWingDings, _gfxFontRuneScape, _gfxFontStarWars,
+					   _gfxFontBadKerning, _gfxFontChozo, _gfxFontGreek, _gfxFontHylian, _gfxFontKlingon, _gfxFontLeetSpeak,
+					   _gfxFontLotR, _gfxFontMinecraft, _gfxFontDots, _gfxFontRoman, _gfxFontBars, _gfxFontAnalogue,
+					   _gfxFontDice, _gfxFontBinary, _gfxFontAscii, _gfxFontTallies, _gfxFontElements};
+	results.push_back(measure("applyPatch (fonts)", samples, 1, [&]() {
+		for (wxByte *font : fonts) {
+			_rom->applyPatch(font);
+		}
+	}));
+
+	// And there and back through OkHSV for every 15bit colour
+	volatile uint16_t sink = 0;
+	results.push_back(measure("okhsv round trip", samples, 0x8000, [&]() {
+		uint16_t colour = next++ & 0x7FFF;
+		sink = okhsvTo15(okhsvFrom15(colour));
+	}));
+}
+
+int main(int argc, char **argv) {
+	wxInitializer initializer;
+	if (initializer.IsOk() == false) {
+		std::cout << "couldn't initialize wxWidgets" << std::endl;
+		return 1;
+	}
+
+	std::string romPath = "";
+	std::string baselinePath = "bench.baseline";
+	bool save = false;
+	int samples = kBenchSamples;
+	std::string tracePath = "";
+	std::string countersPath = "";
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if ((arg == "--rom") && ((i + 1) < argc)) {
+			romPath = argv[++i];
+
+		} else if ((arg == "--baseline") && ((i + 1) < argc)) {
+			baselinePath = argv[++i];
+
+		} else if (arg == "--save") {
+			save = true;
+
+		} else if ((arg == "--samples") && ((i + 1) < argc)) {
+			samples = std::max(1, atoi(argv[++i]));
+
+		} else if ((arg == "--trace") && ((i + 1) < argc)) {
+			tracePath = argv[++i];
+
+		} else if ((arg == "--counters") && ((i + 1) < argc)) {
+			countersPath = argv[++i];
+
+		} else {
+			std::cout << "usage: bench [--rom <base rom>] [--baseline <file>] [--save] [--samples <n>] [--trace <file>] [--counters <file>]" << std::endl;
+			return 1;
+		}
+	}
+
+	Bench bench;
+	if (bench.load(romPath) == false) {
+		return 1;
+	}
+
+	std::vector<BenchResult> results;
+	std::vector<std::pair<wxString, LogicCounters>> counters;
+	bench.run(samples, results, counters);
+
+	std::vector<BenchResult> baseline = readBaseline(baselinePath);
+	bool regressed = false;
+
+	std::cout << wxString::Format("%-28s %12s %10s %12s %12s %12s  %s", "benchmark", "ns/op", "allocs/op", "p50", "p90", "p99", "vs baseline") << std::endl;
+	for (const BenchResult &result : results) {
+		wxString compared = "";
+		for (const BenchResult &base : baseline) {
+			if ((base.name != result.name) || (base.ns <= 0)) {
+				continue;
+			}
+
+			// Slower by more than the tolerance, or any more allocations, is a regression
+			double change = ((result.ns - base.ns) * 100) / base.ns;
+			bool slower = change > kBenchTolerance;
+			bool allocates = result.allocs > (base.allocs + 0.5);
+			compared = wxString::Format("%+.1f%%%s%s", change, (slower == true) ? " SLOWER" : "", (allocates == true) ? " MORE ALLOCS" : "");
+			regressed |= (slower == true) || (allocates == true);
+		}
+
+		std::cout << wxString::Format("%-28s %12.0f %10.1f %12.0f %12.0f %12.0f  %s", result.name, result.ns, result.allocs,
+									  result.p50, result.p90, result.p99, compared) << std::endl;
+	}
+
+	// The counters include the untimed first sample too, which is why they're shown per seed
+	std::cout << std::endl;
+	for (const std::pair<wxString, LogicCounters> &entry : counters) {
+		wxString line = entry.first + ":";
+		for (int c = 0; c < kNumLogicCounters; c++) {
+			double perSeed = (entry.second.seeds > 0) ? ((double) entry.second.counts[c] / entry.second.seeds) : 0;
+			if (c == kCountMaxRequirementSets) {
+				perSeed = entry.second.counts[c];
+			}
+			line += wxString::Format(" %s %.1f", kLogicCounterNames[c], perSeed);
+		}
+		std::cout << line << std::endl;
+	}
+
+	if (countersPath != "") {
+		std::ofstream file(countersPath);
+		file << LogicCounters::csvHeader() << '\n';
+		for (const std::pair<wxString, LogicCounters> &entry : counters) {
+			file << entry.second.csvRow(entry.first) << '\n';
+		}
+	}
+
+#ifdef RANDO_ALLOC_TRACKING
+	std::cout << std::endl << allocReport();
+#endif
+
+	// Only the most recent events of each thread are kept, which is plenty to see where one op spends its time
+	if ((tracePath != "") && (traceExport(tracePath) == false)) {
+		std::cout << "couldn't save the trace to " << tracePath << std::endl;
+	}
+
+	if (save == true) {
+		writeBaseline(baselinePath, results);
+		std::cout << "saved baseline to " << baselinePath << std::endl;
+		return 0;
+	}
+	return (regressed == true) ? 1 : 0;
+}
@@ -0,0 +1,186 @@
+// Project Base Randomizer
+// Client
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Client
+ * Asks a daemon (daemon.cpp) for a seed, and saves the patch and spoiler log
+ * it gets back as <out>.ips and <out>.txt. It only needs the socket, so it
+ * works on anything the daemon is running on, with or without a network.
+ *
+ * client [--socket <path>] [--out <name>] [--repeat <n>] [<setting> <value>]...
+ *
+ * The settings are the same as the lines of a request, for example:
+ *
+ *   client --out seed1234 seed 1234 difficulty "Very Hard" shuffleTilePal 1
+ *
+ * With --repeat, it makes the same request n times, each one with the next seed
+ * (so none of them get put back from the daemon's stages), and says how long
+ * they took. Only the last one gets saved.
+ */
+struct Answer {
+	std::string patch;
+	std::string spoiler;
+};
+
+static int connectTo(const std::string &path) {
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	strcpy(address.sun_path, path.c_str());
+
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if ((server >= 0) && (connect(server, (sockaddr *) &address, sizeof(address)) < 0)) {
+		close(server);
+		return -1;
+	}
+	return server;
+}
+
+// Sends the request, and reads back everything until the daemon hangs up
+static bool ask(const std::string &path, const std::string &request, Answer &answer, std::string &error) {
+	int server = connectTo(path);
+	if (server < 0) {
+		error = "couldn't connect to " + path + ": " + strerror(errno);
+		return false;
+	}
+
+	size_t sent = 0;
+	while (sent < request.size()) {
+		ssize_t written = write(server, request.data() + sent, request.size() - sent);
+		if ((written < 0) && (errno != EINTR)) {
+			error = std::string("couldn't send the request: ") + strerror(errno);
+			close(server);
+			return false;
+		}
+		sent += (written > 0) ? written : 0;
+	}
+
+	std::string response;
+	char chunk[65536];
+	while (true) {
+		ssize_t got = read(server, chunk, sizeof(chunk));
+		if ((got < 0) && (errno == EINTR)) {
+			continue;
+
+		} else if (got <= 0) {
+			break;
+		}
+		response.append(chunk, got);
+	}
+	close(server);
+
+	size_t newline = response.find('\n');
+	if (newline == std::string::npos) {
+		error = "the daemon hung up without answering";
+		return false;
+	}
+
+	std::istringstream header(response.substr(0, newline));
+	std::string status;
+	size_t patchSize = 0;
+	size_t spoilerSize = 0;
+	header >> status;
+	if (status != "ok") {
+		error = response.substr(0, newline);
+		return false;
+	}
+
+	header >> patchSize >> spoilerSize;
+	if ((header.fail() == true) || ((newline + 1 + patchSize + spoilerSize) != response.size())) {
+		error = "the answer was cut short";
+		return false;
+	}
+
+	answer.patch = response.substr(newline + 1, patchSize);
+	answer.spoiler = response.substr(newline + 1 + patchSize, spoilerSize);
+	return true;
+}
+
+int main(int argc, char **argv) {
+	std::string socketPath = "rando.sock";
+	std::string out = "seed";
+	int repeat = 1;
+	std::vector<std::pair<std::string, std::string>> settings;
+	long seed = -1;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if ((arg == "--socket") && ((i + 1) < argc)) {
+			socketPath = argv[++i];
+
+		} else if ((arg == "--out") && ((i + 1) < argc)) {
+			out = argv[++i];
+
+		} else if ((arg == "--repeat") && ((i + 1) < argc)) {
+			repeat = std::max(1, atoi(argv[++i]));
+
+		} else if ((arg.compare(0, 2, "--") != 0) && ((i + 1) < argc)) {
+			// The seed is kept apart, so --repeat can count up from it
+			if (arg == "seed") {
+				seed = atol(argv[++i]);
+			} else {
+				settings.push_back(std::make_pair(arg, std::string(argv[++i])));
+			}
+
+		} else {
+			std::cout << "usage: client [--socket <path>] [--out <name>] [--repeat <n>] [<setting> <value>]..." << std::endl;
+			return 1;
+		}
+	}
+
+	// Without a seed, any will do
+	if (seed < 0) {
+		seed = (rand() ^ time(0)) & 0x7FFFFFFF;
+	}
+
+	Answer answer;
+	double total = 0;
+	double slowest = 0;
+	for (int r = 0; r < repeat; r++) {
+		std::string request = "seed " + std::to_string(seed + r) + "\n";
+		for (const std::pair<std::string, std::string> &setting : settings) {
+			request += setting.first + " " + setting.second + "\n";
+		}
+		request += "end\n";
+
+		std::string error;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (ask(socketPath, request, answer, error) == false) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		total += ms;
+		slowest = std::max(slowest, ms);
+	}
+
+	std::ofstream(out + ".ips", std::ios::binary) << answer.patch;
+	std::ofstream(out + ".txt", std::ios::binary) << answer.spoiler;
+
+	std::cout << "seed " << (seed + repeat - 1) << ": " << answer.patch.size() << " byte patch, " << answer.spoiler.size() << " byte spoiler, saved as " << out << ".ips/.txt" << std::endl;
+	if (repeat > 1) {
+		std::cout << repeat << " requests, " << (total / repeat) << "ms each on average, " << slowest << "ms at most" << std::endl;
+	} else {
+		std::cout << "took " << total << "ms" << std::endl;
+	}
+	return 0;
+}
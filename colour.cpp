@@ -0,0 +1,737 @@
+#include "colour.h"
+
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+
+const uint8_t kColour5To8[32] = {
+	0x00, 0x08, 0x10, 0x19, 0x21, 0x29, 0x31, 0x3A,
+	0x42, 0x4A, 0x52, 0x5A, 0x63, 0x6B, 0x73, 0x7B,
+	0x84, 0x8C, 0x94, 0x9C, 0xA5, 0xAD, 0xB5, 0xBD,
+	0xC5, 0xCE, 0xD6, 0xDE, 0xE6, 0xEF, 0xF7, 0xFF
+};
+
+const uint8_t kColour8To5[256] = {
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02,
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x06, 0x06,
+	0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x08, 0x08,
+	0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x0A,
+	0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0C,
+	0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D,
+	0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+	0x12, 0x12, 0x12, 0x12, 0x12, 0x12, 0x12, 0x12, 0x12, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13,
+	0x13, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x15, 0x15, 0x15, 0x15, 0x15, 0x15, 0x15,
+	0x15, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x17, 0x17, 0x17, 0x17, 0x17, 0x17,
+	0x17, 0x17, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19,
+	0x19, 0x19, 0x1A, 0x1A, 0x1A, 0x1A, 0x1A, 0x1A, 0x1A, 0x1A, 0x1B, 0x1B, 0x1B, 0x1B, 0x1B, 0x1B,
+	0x1B, 0x1B, 0x1B, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1D, 0x1D, 0x1D, 0x1D, 0x1D,
+	0x1D, 0x1D, 0x1D, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F
+};
+
+enum ColourTableSizes {
+	kNumColours = 0x8000,
+	kGridHues	= 256,		// The OkHSV -> 15bit grid is this many steps around the hue circle
+	kGridSats	= 32,		// And this many saturation steps from 0 to kGridMaxSat
+	kGridVals	= 256,		// And this many value steps from 0 to kGridMaxVal
+	kGridEmpty	= 0xFFFF	// Marks a grid cell that hasn't been worked out yet (no 15bit colour uses the top bit)
+};
+
+// With 0-255 channels, saturation goes a little past 1 and value stays under 255
+static const Fixed kGridMaxSat = (kFixedOne * 9) / 8;
+static const Fixed kGridMaxVal = kFixedOne * 255;
+
+/* Fixed point maths
+ * Everything here is 40.24 fixed point, with 128bit intermediates so that
+ * multiplying and dividing don't lose the top or bottom bits. Square and cube
+ * roots are worked out on integers with newton's method, and the angles with
+ * CORDIC, so nothing depends on how a particular libm rounds.
+ */
+typedef __int128 FixedWide;
+typedef unsigned __int128 FixedWideU;
+
+static inline Fixed fixedMul(Fixed a, Fixed b) {
+	return (Fixed) (((FixedWide) a * b) >> kFixedShift);
+}
+
+static inline Fixed fixedDiv(Fixed a, Fixed b) {
+	// Nothing should divide by zero, but if a colour manages it we want a wrong colour, not a crash
+	if (b == 0) {
+		return 0;
+	}
+	return (Fixed) (((FixedWide) a << kFixedShift) / b);
+}
+
+static int bitLength(FixedWideU n) {
+	int bits = 0;
+	while (n != 0) {
+		n >>= 1;
+		bits++;
+	}
+	return bits;
+}
+
+// Newton's method from a starting point above the root only ever goes down, so the first step that doesn't is the floor of the root
+static FixedWideU isqrt(FixedWideU n) {
+	if (n == 0) {
+		return 0;
+	}
+	FixedWideU x = (FixedWideU) 1 << ((bitLength(n) + 1) / 2);
+	while (true) {
+		FixedWideU y = (x + (n / x)) / 2;
+		if (y >= x) {
+			return x;
+		}
+		x = y;
+	}
+}
+
+static FixedWideU icbrt(FixedWideU n) {
+	if (n == 0) {
+		return 0;
+	}
+	FixedWideU x = (FixedWideU) 1 << ((bitLength(n) + 2) / 3);
+	while (true) {
+		FixedWideU y = ((2 * x) + (n / (x * x))) / 3;
+		if (y >= x) {
+			return x;
+		}
+		x = y;
+	}
+}
+
+static Fixed fixedSqrt(Fixed a) {
+	if (a <= 0) {
+		return 0;
+	}
+	return (Fixed) isqrt((FixedWideU) a << kFixedShift);
+}
+
+static Fixed fixedCbrt(Fixed a) {
+	if (a < 0) {
+		return -fixedCbrt(-a);
+	}
+	return (Fixed) icbrt((FixedWideU) a << (2 * kFixedShift));
+}
+
+/* CORDIC
+ * Angles are in turns as 32.32 fixed point, which is more precise than the
+ * rest of the maths needs so the rounding errors don't add up. kCordicAtan is
+ * atan(2^-i) for each step, and kCordicGain undoes how much the rotations
+ * stretch the vector (as 2.30 fixed point).
+ */
+enum CordicValues {
+	kCordicSteps	= 32,
+	kCordicShift	= 32,
+	kCordicGainShift= 30
+};
+
+static const int64_t kCordicAtan[kCordicSteps] = {
+	536870912, 316933406, 167458907, 85004756, 42667331, 21354465, 10679838, 5340245,
+	2670163, 1335087, 667544, 333772, 166886, 83443, 41722, 20861,
+	10430, 5215, 2608, 1304, 652, 326, 163, 81,
+	41, 20, 10, 5, 3, 1, 1, 0
+};
+
+static const int64_t kCordicGain = 652032874;
+static const int64_t kQuarterTurn = (int64_t) 1 << (kCordicShift - 2);
+static const int64_t kHalfTurn = (int64_t) 1 << (kCordicShift - 1);
+
+// The angle of (x, y) in turns, from 0 to 1
+static Fixed atan2Turns(Fixed y, Fixed x) {
+	if ((x == 0) && (y == 0)) {
+		return 0;
+	}
+
+	// CORDIC only works on the right half, so the left half gets turned around first
+	int64_t z = 0;
+	if (x < 0) {
+		z = kHalfTurn;
+		x = -x;
+		y = -y;
+	}
+
+	// The bigger the vector, the more precise each step is
+	while ((std::max(x, std::abs(y))) < ((Fixed) 1 << 40)) {
+		x *= 2;
+		y *= 2;
+	}
+
+	for (int i = 0; i < kCordicSteps; i++) {
+		Fixed dx = x >> i;
+		Fixed dy = y >> i;
+		if (y > 0) {
+			x += dy;
+			y -= dx;
+			z += kCordicAtan[i];
+		} else {
+			x -= dy;
+			y += dx;
+			z -= kCordicAtan[i];
+		}
+	}
+
+	int64_t turns = (z + ((int64_t) 1 << (kCordicShift - kFixedShift - 1))) >> (kCordicShift - kFixedShift);
+	return wrapHue(turns);
+}
+
+// The cosine and sine of an angle in turns
+static void sinCosTurns(Fixed h, Fixed &c, Fixed &s) {
+	int64_t z = wrapHue(h) << (kCordicShift - kFixedShift);
+
+	// And this only works from -1/4 to 1/4 of a turn, so anything else gets turned around
+	bool flip = false;
+	if (z > (3 * kQuarterTurn)) {
+		z -= 4 * kQuarterTurn;
+	} else if (z > kQuarterTurn) {
+		z -= kHalfTurn;
+		flip = true;
+	}
+
+	int64_t x = kCordicGain;
+	int64_t y = 0;
+	for (int i = 0; i < kCordicSteps; i++) {
+		int64_t dx = x >> i;
+		int64_t dy = y >> i;
+		if (z >= 0) {
+			x -= dy;
+			y += dx;
+			z -= kCordicAtan[i];
+		} else {
+			x += dy;
+			y -= dx;
+			z += kCordicAtan[i];
+		}
+	}
+
+	const int shift = kCordicGainShift - kFixedShift;
+	c = (x + (1 << (shift - 1))) >> shift;
+	s = (y + (1 << (shift - 1))) >> shift;
+	if (flip == true) {
+		c = -c;
+		s = -s;
+	}
+}
+
+// Copyright(c) 2021 Björn Ottosson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/* OkLab and OkHSV
+ * These are the same steps as Björn Ottosson's reference OkLab and OkHSV code,
+ * just in fixed point. The constants are the same ones rounded to 24 bits. The transfer function only ever has to deal
+ * with the 32 channel values the SNES has, so it is tables in both directions.
+ */
+
+// The linear value of each 5bit channel value (as 8bit, through the sRGB transfer function)
+static const Fixed kLinear[32] = {
+	0, 2205318396, 11544595922, 33593911193, 65325565870, 109898693213, 168482137984, 252423104286,
+	344102371220, 452735468774, 579116731338, 723990364329, 909949641791, 1096404190509, 1303428416688, 1531624230138,
+	1814369061593, 2089443710102, 2387423044365, 2708821850906, 3099008993729, 3471810056931, 3869539171845, 4292651143018,
+	4741588864870, 5278050854147, 5783289023856, 6315668531975, 6875590719741, 7538913995613, 8158658355622, 8807146344334
+};
+
+// The lowest linear value that rounds to each 5bit channel value (from 1 up)
+static const Fixed kLinearThreshold[31] = {
+	720849791, 7027138214, 22129244266, 47934047762, 91601405183, 144803240453, 212676784179, 296195369431,
+	396248765861, 529595658289, 667450281349, 824240426703, 1000644367507, 1223345048928, 1443532605327, 1685255254692,
+	1949076157013, 2235537715051, 2585520853272, 2921810880502, 3282322433118, 3667529893525, 4130981236605, 4570183122051,
+	5035481876969, 5527302704855, 6046060819662, 6662367129150, 7239703461740, 7845216549517, 8479286181949
+};
+
+// Fixed point of a constant
+#define FX(x) ((Fixed) (((x) * (double) kFixedOne) + (((x) < 0) ? -0.5 : 0.5)))
+
+struct FixedRGB {
+	Fixed r;
+	Fixed g;
+	Fixed b;
+};
+
+static int channelFromLinear(Fixed linear) {
+	return std::upper_bound(kLinearThreshold, kLinearThreshold + 31, linear) - kLinearThreshold;
+}
+
+static FixedLab linearToOklab(const FixedRGB &c) {
+	Fixed l = fixedMul(FX(0.4122214708), c.r) + fixedMul(FX(0.5363325363), c.g) + fixedMul(FX(0.0514459929), c.b);
+	Fixed m = fixedMul(FX(0.2119034982), c.r) + fixedMul(FX(0.6806995451), c.g) + fixedMul(FX(0.1073969566), c.b);
+	Fixed s = fixedMul(FX(0.0883024619), c.r) + fixedMul(FX(0.2817188376), c.g) + fixedMul(FX(0.6299787005), c.b);
+
+	Fixed l_ = fixedCbrt(l);
+	Fixed m_ = fixedCbrt(m);
+	Fixed s_ = fixedCbrt(s);
+
+	return {
+		fixedMul(FX(0.2104542553), l_) + fixedMul(FX(0.7936177850), m_) - fixedMul(FX(0.0040720468), s_),
+		fixedMul(FX(1.9779984951), l_) - fixedMul(FX(2.4285922050), m_) + fixedMul(FX(0.4505937099), s_),
+		fixedMul(FX(0.0259040371), l_) + fixedMul(FX(0.7827717662), m_) - fixedMul(FX(0.8086757660), s_)
+	};
+}
+
+static FixedRGB oklabToLinear(const FixedLab &c) {
+	Fixed l_ = c.L + fixedMul(FX(0.3963377774), c.a) + fixedMul(FX(0.2158037573), c.b);
+	Fixed m_ = c.L - fixedMul(FX(0.1055613458), c.a) - fixedMul(FX(0.0638541728), c.b);
+	Fixed s_ = c.L - fixedMul(FX(0.0894841775), c.a) - fixedMul(FX(1.2914855480), c.b);
+
+	Fixed l = fixedMul(fixedMul(l_, l_), l_);
+	Fixed m = fixedMul(fixedMul(m_, m_), m_);
+	Fixed s = fixedMul(fixedMul(s_, s_), s_);
+
+	return {
+		fixedMul(FX(4.0767416621), l) - fixedMul(FX(3.3077115913), m) + fixedMul(FX(0.2309699292), s),
+		fixedMul(FX(-1.2684380046), l) + fixedMul(FX(2.6097574011), m) - fixedMul(FX(0.3413193965), s),
+		fixedMul(FX(-0.0041960863), l) - fixedMul(FX(0.7034186147), m) + fixedMul(FX(1.7076147010), s)
+	};
+}
+
+// The saturation (C/L) where a hue leaves the sRGB gamut, a and b have to be normalized
+static Fixed maxSaturation(Fixed a, Fixed b) {
+	Fixed k0, k1, k2, k3, k4, wl, wm, ws;
+
+	// Which channel goes below zero first decides which polynomial to use
+	if ((fixedMul(FX(-1.88170328), a) - fixedMul(FX(0.80936493), b)) > kFixedOne) {
+		k0 = FX(1.19086277); k1 = FX(1.76576728); k2 = FX(0.59662641); k3 = FX(0.75515197); k4 = FX(0.56771245);
+		wl = FX(4.0767416621); wm = FX(-3.3077115913); ws = FX(0.2309699292);
+
+	} else if ((fixedMul(FX(1.81444104), a) - fixedMul(FX(1.19445276), b)) > kFixedOne) {
+		k0 = FX(0.73956515); k1 = FX(-0.45954404); k2 = FX(0.08285427); k3 = FX(0.12541070); k4 = FX(0.14503204);
+		wl = FX(-1.2684380046); wm = FX(2.6097574011); ws = FX(-0.3413193965);
+
+	} else {
+		k0 = FX(1.35733652); k1 = FX(-0.00915799); k2 = FX(-1.15130210); k3 = FX(-0.50559606); k4 = FX(0.00692167);
+		wl = FX(-0.0041960863); wm = FX(-0.7034186147); ws = FX(1.7076147010);
+	}
+
+	Fixed S = k0 + fixedMul(k1, a) + fixedMul(k2, b) + fixedMul(k3, fixedMul(a, a)) + fixedMul(k4, fixedMul(a, b));
+
+	// Then one step of Halley's method to get closer
+	Fixed k_l = fixedMul(FX(0.3963377774), a) + fixedMul(FX(0.2158037573), b);
+	Fixed k_m = fixedMul(FX(-0.1055613458), a) - fixedMul(FX(0.0638541728), b);
+	Fixed k_s = fixedMul(FX(-0.0894841775), a) - fixedMul(FX(1.2914855480), b);
+
+	Fixed l_ = kFixedOne + fixedMul(S, k_l);
+	Fixed m_ = kFixedOne + fixedMul(S, k_m);
+	Fixed s_ = kFixedOne + fixedMul(S, k_s);
+
+	Fixed l = fixedMul(fixedMul(l_, l_), l_);
+	Fixed m = fixedMul(fixedMul(m_, m_), m_);
+	Fixed s = fixedMul(fixedMul(s_, s_), s_);
+
+	Fixed l_dS = 3 * fixedMul(k_l, fixedMul(l_, l_));
+	Fixed m_dS = 3 * fixedMul(k_m, fixedMul(m_, m_));
+	Fixed s_dS = 3 * fixedMul(k_s, fixedMul(s_, s_));
+
+	Fixed l_dS2 = 6 * fixedMul(fixedMul(k_l, k_l), l_);
+	Fixed m_dS2 = 6 * fixedMul(fixedMul(k_m, k_m), m_);
+	Fixed s_dS2 = 6 * fixedMul(fixedMul(k_s, k_s), s_);
+
+	Fixed f = fixedMul(wl, l) + fixedMul(wm, m) + fixedMul(ws, s);
+	Fixed f1 = fixedMul(wl, l_dS) + fixedMul(wm, m_dS) + fixedMul(ws, s_dS);
+	Fixed f2 = fixedMul(wl, l_dS2) + fixedMul(wm, m_dS2) + fixedMul(ws, s_dS2);
+
+	return S - fixedDiv(fixedMul(f, f1), fixedMul(f1, f1) - (fixedMul(f, f2) / 2));
+}
+
+// The S and T of the cusp (the most saturated colour) of a hue
+static void cuspST(Fixed a, Fixed b, Fixed &S, Fixed &T) {
+	Fixed S_cusp = maxSaturation(a, b);
+
+	FixedRGB rgb = oklabToLinear({kFixedOne, fixedMul(S_cusp, a), fixedMul(S_cusp, b)});
+	Fixed L_cusp = fixedCbrt(fixedDiv(kFixedOne, std::max(std::max(rgb.r, rgb.g), rgb.b)));
+	Fixed C_cusp = fixedMul(L_cusp, S_cusp);
+
+	S = fixedDiv(C_cusp, L_cusp);
+	T = fixedDiv(C_cusp, kFixedOne - L_cusp);
+}
+
+static const Fixed kToeK1 = FX(0.206);
+static const Fixed kToeK2 = FX(0.03);
+static const Fixed kToeK3 = FX(1.206 / 1.03);
+
+static Fixed toe(Fixed x) {
+	Fixed y = fixedMul(kToeK3, x) - kToeK1;
+	return (y + fixedSqrt(fixedMul(y, y) + (4 * fixedMul(kToeK2, fixedMul(kToeK3, x))))) / 2;
+}
+
+static Fixed toeInv(Fixed x) {
+	return fixedDiv(fixedMul(x, x) + fixedMul(kToeK1, x), fixedMul(kToeK3, x + kToeK2));
+}
+
+// How much the curved top of the gamut squashes a colour compared to the triangle approximation
+static Fixed gamutScale(Fixed L_vt, Fixed C_vt, Fixed a, Fixed b) {
+	FixedRGB rgb = oklabToLinear({L_vt, fixedMul(a, C_vt), fixedMul(b, C_vt)});
+	return fixedCbrt(fixedDiv(kFixedOne, std::max(std::max(rgb.r, rgb.g), std::max(rgb.b, (Fixed) 0))));
+}
+
+static const Fixed kS0 = kFixedOne / 2;
+
+static FixedHSV oklabToOkhsv(const FixedLab &lab) {
+	Fixed C = fixedSqrt(fixedMul(lab.a, lab.a) + fixedMul(lab.b, lab.b));
+
+	// Greys have no hue, but they still have a value, which only depends on L
+	if (C == 0) {
+		return {0, 0, toe(lab.L)};
+	}
+
+	Fixed a = fixedDiv(lab.a, C);
+	Fixed b = fixedDiv(lab.b, C);
+	Fixed L = lab.L;
+	Fixed h = atan2Turns(lab.b, lab.a);
+
+	Fixed S_max;
+	Fixed T_max;
+	cuspST(a, b, S_max, T_max);
+	Fixed k = kFixedOne - fixedDiv(kS0, S_max);
+
+	Fixed t = fixedDiv(T_max, C + fixedMul(L, T_max));
+	Fixed L_v = fixedMul(t, L);
+	Fixed C_v = fixedMul(t, C);
+
+	Fixed L_vt = toeInv(L_v);
+	Fixed C_vt = fixedDiv(fixedMul(C_v, L_vt), L_v);
+
+	Fixed scale = gamutScale(L_vt, C_vt, a, b);
+	L = fixedDiv(L, scale);
+	C = fixedDiv(C, scale);
+
+	Fixed L_toe = toe(L);
+	C = fixedDiv(fixedMul(C, L_toe), L);
+	L = L_toe;
+
+	Fixed v = fixedDiv(L, L_v);
+	Fixed s = fixedDiv(fixedMul(kS0 + T_max, C_v), fixedMul(T_max, kS0) + fixedMul(fixedMul(T_max, k), C_v));
+	return {h, s, v};
+}
+
+static uint16_t okhsvToColour(const FixedHSV &hsv) {
+	if (hsv.v <= 0) {
+		return 0;
+	}
+
+	Fixed a;
+	Fixed b;
+	sinCosTurns(hsv.h, a, b);
+
+	Fixed S_max;
+	Fixed T_max;
+	cuspST(a, b, S_max, T_max);
+	Fixed k = kFixedOne - fixedDiv(kS0, S_max);
+
+	// First L and C as if the gamut was a perfect triangle
+	Fixed d = kS0 + T_max - fixedMul(fixedMul(T_max, k), hsv.s);
+	Fixed L_v = kFixedOne - fixedDiv(fixedMul(hsv.s, kS0), d);
+	Fixed C_v = fixedDiv(fixedMul(fixedMul(hsv.s, T_max), kS0), d);
+
+	Fixed L = fixedMul(hsv.v, L_v);
+	Fixed C = fixedMul(hsv.v, C_v);
+
+	// Then we make up for the toe and the curved top of the gamut
+	Fixed L_vt = toeInv(L_v);
+	Fixed C_vt = fixedDiv(fixedMul(C_v, L_vt), L_v);
+
+	Fixed L_new = toeInv(L);
+	C = fixedDiv(fixedMul(C, L_new), L);
+	L = L_new;
+
+	Fixed scale = gamutScale(L_vt, C_vt, a, b);
+	L = fixedMul(L, scale);
+	C = fixedMul(C, scale);
+
+	return oklabTo15({L, fixedMul(C, a), fixedMul(C, b)});
+}
+
+static FixedHSV *hsvTable = nullptr;
+static FixedLab *labTable = nullptr;
+static std::atomic<uint16_t> *gridTable = nullptr;
+
+static std::once_flag hsvOnce;
+static std::once_flag labOnce;
+static std::once_flag gridOnce;
+
+const FixedHSV &okhsvFrom15(uint16_t clr) {
+	// The table is only built the first time anything asks for it
+	std::call_once(hsvOnce, []() {
+		hsvTable = new FixedHSV[kNumColours];
+		for (int i = 0; i < kNumColours; i++) {
+			hsvTable[i] = oklabToOkhsv(oklabFrom15(i));
+		}
+	});
+	return hsvTable[clr & 0x7FFF];
+}
+
+const FixedLab &oklabFrom15(uint16_t clr) {
+	std::call_once(labOnce, []() {
+		labTable = new FixedLab[kNumColours];
+		for (int i = 0; i < kNumColours; i++) {
+			labTable[i] = linearToOklab({kLinear[i & 0x1F], kLinear[(i >> 5) & 0x1F], kLinear[(i >> 10) & 0x1F]});
+		}
+	});
+	return labTable[clr & 0x7FFF];
+}
+
+uint16_t oklabTo15(const FixedLab &lab) {
+	FixedRGB rgb = oklabToLinear(lab);
+	return channelFromLinear(rgb.r) | (channelFromLinear(rgb.g) << 5) | (channelFromLinear(rgb.b) << 10);
+}
+
+static int gridIndex(Fixed x, Fixed max, int steps) {
+	if (x <= 0) {
+		return 0;
+	}
+	Fixed index = ((x * (steps - 1)) + (max / 2)) / max;
+	return (int) std::min(index, (Fixed) (steps - 1));
+}
+
+// The grid is too big to fill all at once, so each cell only gets worked out when something lands in it
+static void makeGrid() {
+	std::call_once(gridOnce, []() {
+		gridTable = new std::atomic<uint16_t>[kGridHues * kGridSats * kGridVals];
+		for (int i = 0; i < (kGridHues * kGridSats * kGridVals); i++) {
+			gridTable[i].store(kGridEmpty, std::memory_order_relaxed);
+		}
+	});
+}
+
+// Which cell of the grid an OkHSV value lands in. Hue wraps around, the others are clamped
+static int gridCell(const FixedHSV &hsv) {
+	int h = (int) (((wrapHue(hsv.h) * kGridHues) + (kFixedOne / 2)) >> kFixedShift) % kGridHues;
+	int s = gridIndex(hsv.s, kGridMaxSat, kGridSats);
+	int v = gridIndex(hsv.v, kGridMaxVal, kGridVals);
+	return (((h * kGridSats) + s) * kGridVals) + v;
+}
+
+// Every thread works out the same colour from the middle of the cell, so it doesn't matter who stores it first
+static uint16_t fillGridCell(int cell) {
+	int v = cell % kGridVals;
+	int s = (cell / kGridVals) % kGridSats;
+	int h = cell / (kGridVals * kGridSats);
+	uint16_t clr = okhsvToColour({(kFixedOne * h) / kGridHues, (kGridMaxSat * s) / (kGridSats - 1), (kGridMaxVal * v) / (kGridVals - 1)});
+	gridTable[cell].store(clr, std::memory_order_relaxed);
+	return clr;
+}
+
+uint16_t okhsvTo15(const FixedHSV &hsv) {
+	if (hsv.v <= 0) {
+		return 0;
+	}
+
+	makeGrid();
+	int cell = gridCell(hsv);
+	uint16_t clr = gridTable[cell].load(std::memory_order_relaxed);
+	if (clr != kGridEmpty) {
+		return clr;
+	}
+	return fillGridCell(cell);
+}
+
+/* The batch versions only check that the tables exist once, and then go straight
+ * to them. For OkHSV to 15bit, every colour gets looked up in the grid first, and
+ * only the ones that land in empty cells go back for the slow conversion after.
+ */
+void okhsvFrom15(const uint16_t *colours, FixedHSV *out, int count) {
+	okhsvFrom15(0);
+	for (int i = 0; i < count; i++) {
+		out[i] = hsvTable[colours[i] & 0x7FFF];
+	}
+}
+
+void oklabFrom15(const uint16_t *colours, FixedLab *out, int count) {
+	oklabFrom15(0);
+	for (int i = 0; i < count; i++) {
+		out[i] = labTable[colours[i] & 0x7FFF];
+	}
+}
+
+void okhsvTo15(const FixedHSV *hsv, uint16_t *out, int count) {
+	makeGrid();
+	bool missed = false;
+	for (int i = 0; i < count; i++) {
+		out[i] = (hsv[i].v <= 0) ? 0 : gridTable[gridCell(hsv[i])].load(std::memory_order_relaxed);
+		missed |= (out[i] == kGridEmpty);
+	}
+
+	for (int i = 0; (i < count) && (missed == true); i++) {
+		if (out[i] == kGridEmpty) {
+			out[i] = fillGridCell(gridCell(hsv[i]));
+		}
+	}
+}
+
+/* The shift is done as a few flat passes over every colour of every palette at once,
+ * with the channels in separate arrays, instead of one colour at a time. Only the
+ * colours that leave the gamut need the search for how much chroma they can keep.
+ */
+enum ShiftValues {
+	kGamutSteps = 12
+};
+
+// Colours closer in lightness than this (about 1% of white) can't be told apart in a sprite, so they are allowed to swap
+static const Fixed kOrderSlack = kFixedOne;
+
+static bool inGamut(const FixedLab &lab) {
+	FixedRGB rgb = oklabToLinear(lab);
+	return (std::min(std::min(rgb.r, rgb.g), rgb.b) >= 0) && (std::max(std::max(rgb.r, rgb.g), rgb.b) <= kLinear[31]);
+}
+
+void shiftPalettes(uint16_t *colours, int count, int size, const PaletteShift *shifts) {
+	blendPalettes(colours, nullptr, nullptr, count, size, shifts);
+}
+
+void blendPalettes(uint16_t *colours, const uint16_t *blend, const Fixed *amounts, int count, int size, const PaletteShift *shifts) {
+	size_t n = (size_t) count * size;
+	std::vector<Fixed> L(n);
+	std::vector<Fixed> a(n);
+	std::vector<Fixed> b(n);
+	std::vector<Fixed> scale(n, kFixedOne);
+
+	for (size_t i = 0; i < n; i++) {
+		const FixedLab &lab = oklabFrom15(colours[i]);
+		L[i] = lab.L;
+		a[i] = lab.a;
+		b[i] = lab.b;
+	}
+
+	// Only the colour is blended, the lightness always comes from the palette itself
+	for (int p = 0; (p < count) && (blend != nullptr); p++) {
+		for (size_t i = (size_t) p * size; i < ((size_t) (p + 1) * size); i++) {
+			const FixedLab &other = oklabFrom15(blend[i]);
+			a[i] += fixedMul(other.a - a[i], amounts[p]);
+			b[i] += fixedMul(other.b - b[i], amounts[p]);
+		}
+	}
+
+	// Turning the hue and scaling the chroma together is one 2x2 multiply per colour
+	for (int p = 0; p < count; p++) {
+		Fixed c;
+		Fixed s;
+		sinCosTurns(shifts[p].hue, c, s);
+		c = fixedMul(c, shifts[p].chroma);
+		s = fixedMul(s, shifts[p].chroma);
+
+		for (size_t i = (size_t) p * size; i < ((size_t) (p + 1) * size); i++) {
+			Fixed x = a[i];
+			a[i] = fixedMul(x, c) - fixedMul(b[i], s);
+			b[i] = fixedMul(x, s) + fixedMul(b[i], c);
+		}
+	}
+
+	// Anything outside the gamut gets the most chroma it can have at its lightness
+	for (size_t i = 0; i < n; i++) {
+		if (inGamut({L[i], a[i], b[i]}) == true) {
+			continue;
+		}
+
+		Fixed low = 0;
+		Fixed high = kFixedOne;
+		for (int step = 0; step < kGamutSteps; step++) {
+			Fixed mid = (low + high) / 2;
+			if (inGamut({L[i], fixedMul(a[i], mid), fixedMul(b[i], mid)}) == true) {
+				low = mid;
+			} else {
+				high = mid;
+			}
+		}
+		scale[i] = low;
+	}
+
+	std::vector<uint16_t> shifted(n);
+	for (size_t i = 0; i < n; i++) {
+		shifted[i] = oklabTo15({L[i], fixedMul(a[i], scale[i]), fixedMul(b[i], scale[i])});
+	}
+
+	// Rounding to 15bit can still swap two colours that were close, and then that palette just keeps its colours
+	for (int p = 0; p < count; p++) {
+		size_t start = (size_t) p * size;
+		bool ordered = true;
+		for (int j = 0; (j < size) && (ordered == true); j++) {
+			for (int k = 0; k < size; k++) {
+				if (((L[start + j] + kOrderSlack) < L[start + k]) && (oklabFrom15(shifted[start + j]).L > oklabFrom15(shifted[start + k]).L)) {
+					ordered = false;
+					break;
+				}
+			}
+		}
+
+		if (ordered == true) {
+			std::copy(shifted.begin() + start, shifted.begin() + start + size, colours + start);
+		}
+	}
+}
+
+// Half a turn or more would cover the whole circle around a single hue, and then there would be nothing left to take even after starting a new round
+HueAllocator::HueAllocator(Fixed spacing) : _spacing(std::min(std::max(spacing, (Fixed) 0), (kFixedOne / 2) - 1)) {
+	_free.push_back({0, kFixedOne});
+}
+
+Fixed HueAllocator::freeLength() const {
+	Fixed length = 0;
+	for (const Arc &arc : _free) {
+		length += arc.end - arc.start;
+	}
+	return length;
+}
+
+void HueAllocator::exclude(Fixed start, Fixed end) {
+	std::vector<Arc> remaining;
+	for (const Arc &arc : _free) {
+		// Whatever is left on either side of the excluded part stays free
+		if (arc.start < std::min(arc.end, start)) {
+			remaining.push_back({arc.start, std::min(arc.end, start)});
+		}
+		if (std::max(arc.start, end) < arc.end) {
+			remaining.push_back({std::max(arc.start, end), arc.end});
+		}
+	}
+	_free.swap(remaining);
+}
+
+void HueAllocator::excludeAround(Fixed hue) {
+	// Everything within spacing of the hue is taken, which might wrap around either end of the circle
+	Fixed start = hue - _spacing;
+	Fixed end = hue + _spacing + 1;
+	exclude(std::max(start, (Fixed) 0), std::min(end, kFixedOne));
+	if (start < 0) {
+		exclude(start + kFixedOne, kFixedOne);
+	}
+	if (end > kFixedOne) {
+		exclude(0, end - kFixedOne);
+	}
+}
+
+Fixed HueAllocator::take(Fixed random) {
+	// Once the whole circle is taken there's nowhere that keeps the distance, so we start a new round where only the last hue is kept away from
+	if (freeLength() == 0) {
+		_free.assign(1, {0, kFixedOne});
+		excludeAround(_last);
+	}
+
+	// Random is a fraction of the free length, which we walk along the arcs until we reach
+	Fixed position = (Fixed) (((FixedWide) std::min(std::max(random, (Fixed) 0), kFixedOne - 1) * freeLength()) >> kFixedShift);
+	Fixed hue = _free.back().end - 1;
+	for (const Arc &arc : _free) {
+		if (position < (arc.end - arc.start)) {
+			hue = arc.start + position;
+			break;
+		}
+		position -= arc.end - arc.start;
+	}
+
+	excludeAround(hue);
+	_last = hue;
+	return hue;
+}
@@ -0,0 +1,214 @@
+#ifndef RANDO_COLOUR_H
+#define RANDO_COLOUR_H
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+/* Colour tables
+ * The SNES can only show 32768 colours, so instead of doing the colour maths
+ * every time we convert a colour, we do it once for every 15bit colour and
+ * look it up from then on. A 15bit colour here is the same layout the game
+ * uses, 0BBBBBGG GGGRRRRR.
+ */
+extern const uint8_t kColour5To8[32];	// Each 5bit channel value as 8bit
+extern const uint8_t kColour8To5[256];	// Each 8bit channel value as 5bit (rounded to nearest)
+
+// Converts a 24bit colour to 15bit
+inline uint16_t colourTo15(uint8_t r, uint8_t g, uint8_t b) {
+	return kColour8To5[r] | (kColour8To5[g] << 5) | (kColour8To5[b] << 10);
+}
+
+// Converts a 15bit colour to 24bit
+inline void colourFrom15(uint16_t clr, uint8_t &r, uint8_t &g, uint8_t &b) {
+	r = kColour5To8[clr & 0x1F];
+	g = kColour5To8[(clr >> 5) & 0x1F];
+	b = kColour5To8[(clr >> 10) & 0x1F];
+}
+
+/* Palettes
+ * The palette generation works on these instead of wxColour, so a palette is
+ * just 384 bytes in a row and nothing in it needs wx. Colours only get turned
+ * into wxColours when they are shown in the program.
+ */
+struct Rgb {
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+
+	Rgb() = default;
+	constexpr Rgb(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+};
+
+enum PaletteValues {
+	kPaletteColours = 128,		// A tileset palette is 8 lines of 16 colours
+	kPaletteRows = 8,
+	kPaletteRowColours = 16
+};
+
+typedef Rgb Palette128[kPaletteColours];
+
+constexpr Rgb kRgbBlack(0, 0, 0);
+constexpr Rgb kRgbWhite(255, 255, 255);
+constexpr Rgb kRgbLightGrey(192, 192, 192);
+
+inline uint16_t colourTo15(const Rgb &clr) {
+	return colourTo15(clr.r, clr.g, clr.b);
+}
+
+inline Rgb rgbFrom15(uint16_t clr) {
+	return Rgb(kColour5To8[clr & 0x1F], kColour5To8[(clr >> 5) & 0x1F], kColour5To8[(clr >> 10) & 0x1F]);
+}
+
+/* Fixed point
+ * All the colour maths the palettes depend on is done with integers, as
+ * 40.24 fixed point numbers (kFixedOne is 1.0). Floats can round differently
+ * depending on the compiler, the cpu and the optimization flags, which would
+ * mean the same seed giving different palettes on different machines. This
+ * needs a compiler with __int128 (gcc or clang on a 64bit target).
+ */
+typedef int64_t Fixed;
+
+enum FixedValues {
+	kFixedShift = 24
+};
+
+const Fixed kFixedOne = (Fixed) 1 << kFixedShift;
+
+// Converts a float (like a value from a palette template) to fixed point. This is exact for anything with a short enough binary fraction, and always rounds the same way
+inline Fixed toFixed(float x) {
+	return (Fixed) std::floor(((double) x * kFixedOne) + 0.5);
+}
+
+// Hue is in turns, so it wraps around at kFixedOne. Because fixed point is just an integer, this works for negative hues too
+inline Fixed wrapHue(Fixed h) {
+	return h & (kFixedOne - 1);
+}
+
+// A hue shift of some number of degrees
+inline Fixed hueDegrees(float degrees) {
+	return toFixed(degrees) / 360;
+}
+
+struct FixedHSV {
+	Fixed h;
+	Fixed s;
+	Fixed v;
+};
+
+struct FixedLab {
+	Fixed L;
+	Fixed a;
+	Fixed b;
+};
+
+/* These follow the way the rest of the program has always used OkHSV, which is
+ * with the channels as 0-255 instead of 0-1. So v for example goes up to about 110,
+ * not 1. Greys (and black) have no hue, so they come out with h and s as 0.
+ */
+const FixedHSV &okhsvFrom15(uint16_t clr);		// The OkHSV value of a 15bit colour
+const FixedLab &oklabFrom15(uint16_t clr);		// The OkLab value of a 15bit colour
+
+// The nearest 15bit colour to an OkHSV or OkLab value (out of range values are clamped to the nearest colour that exists)
+uint16_t okhsvTo15(const FixedHSV &hsv);
+uint16_t oklabTo15(const FixedLab &lab);
+
+// The same for count colours at once, for loops that make a whole run of colours (like a gradient) before using any of them
+void okhsvFrom15(const uint16_t *colours, FixedHSV *out, int count);
+void oklabFrom15(const uint16_t *colours, FixedLab *out, int count);
+void okhsvTo15(const FixedHSV *hsv, uint16_t *out, int count);
+
+/* Integer versions of wxColour::ChangeLightness, MakeGrey and GetLuminance.
+ * They give the same results wxWidgets would if its doubles never rounded.
+ */
+enum LightnessValues {
+	kLightnessSame	= 100,		// ChangeLightness amounts go from 0 (black) to 200 (white)
+	kLightnessMax	= 200,
+	kLuminanceMax	= 255000,	// luminance() is 0.299r + 0.587g + 0.114b, times 1000
+	kLuminanceHalf	= 127500
+};
+
+inline uint8_t lightenChannel(uint8_t c, int amount) {
+	if (amount < kLightnessSame) {
+		return (c * amount) / 100;
+	}
+	// Blending towards white rounds up the distance to white, because wx truncates the final value
+	return 255 - ((((kLightnessMax - amount) * (255 - c)) + 99) / 100);
+}
+
+inline void changeLightness(uint8_t &r, uint8_t &g, uint8_t &b, int amount) {
+	if (amount == kLightnessSame) {
+		return;
+	}
+	amount = std::min(std::max(amount, 0), (int) kLightnessMax);
+	r = lightenChannel(r, amount);
+	g = lightenChannel(g, amount);
+	b = lightenChannel(b, amount);
+}
+
+inline int luminance(uint8_t r, uint8_t g, uint8_t b) {
+	return (299 * r) + (587 * g) + (114 * b);
+}
+
+inline void makeGrey(uint8_t &r, uint8_t &g, uint8_t &b) {
+	r = g = b = luminance(r, g, b) / 1000;
+}
+
+inline int luminance(const Rgb &clr) {
+	return luminance(clr.r, clr.g, clr.b);
+}
+
+inline Rgb changeLightness(Rgb clr, int amount) {
+	changeLightness(clr.r, clr.g, clr.b, amount);
+	return clr;
+}
+
+inline Rgb makeGrey(Rgb clr) {
+	makeGrey(clr.r, clr.g, clr.b);
+	return clr;
+}
+
+/* Palette shifting
+ * Turns the hue and scales the chroma of a whole batch of palettes in one go, in OkLab
+ * so that the lightness of every colour stays the same. Colours that would leave the
+ * gamut lose chroma instead of lightness, so the shading in each palette stays in order.
+ */
+struct PaletteShift {
+	Fixed hue;		// How far to turn the hue, in turns
+	Fixed chroma;	// How much to scale the chroma by (kFixedOne keeps it the same)
+};
+
+// Shifts count palettes of size 15bit colours each, one after another in colours. A palette that can't keep its lightness order once rounded is left as it was
+void shiftPalettes(uint16_t *colours, int count, int size, const PaletteShift *shifts);
+
+// The same, but first each palette's colour (not lightness) is blended towards the same palette in blend, by its amount (0 to kFixedOne)
+void blendPalettes(uint16_t *colours, const uint16_t *blend, const Fixed *amounts, int count, int size, const PaletteShift *shifts);
+
+/* Hue allocation
+ * Hands out hues that are at least some distance away from every hue it has already
+ * handed out. It keeps track of which arcs of the hue circle are still free, and picks
+ * a point in them directly, so it never has to keep trying colours until one fits.
+ */
+class HueAllocator {
+public:
+	HueAllocator(Fixed spacing);
+
+	Fixed take(Fixed random);		// Takes a free hue. Random (0 to kFixedOne) picks where it is in the free arcs
+	Fixed freeLength() const;		// How much of the circle is still free
+
+private:
+	struct Arc {
+		Fixed start;
+		Fixed end;
+	};
+
+	std::vector<Arc> _free;
+	Fixed _spacing;
+	Fixed _last = 0;
+
+	void exclude(Fixed start, Fixed end);
+	void excludeAround(Fixed hue);
+};
+
+#endif
@@ -0,0 +1,392 @@
+#include "compression.h"
+
+#include <cstring>
+#include <algorithm>
+
+/* The decompression is based on code converted to c++ from https://github.com/DJuttmann/SM3E/blob/master/SM3E/Tools/Compression.cs
+ * thank you so much DJuttmann! */
+enum LZ5Commands {
+	kCmdDirect		= 0x0,
+	kCmdByteFill	= 0x1,
+	kCmdWordFill	= 0x2,
+	kCmdIncrement	= 0x3,
+	kCmdCopy		= 0x4,
+	kCmdXorCopy		= 0x5,
+	kCmdNegCopy		= 0x6,
+	kCmdNegXorCopy	= 0x7
+};
+
+// The number of argument bytes that follow the header of each command (direct copies use the length instead)
+static const int kArgBytes[8] = {0, 1, 2, 1, 2, 2, 1, 1};
+
+// Every command starts with a header, which is either one byte (3 bit command, 5 bit length) or two bytes (111, 3 bit command, 10 bit length)
+static inline bool readHeader(const uint8_t *input, size_t inputLength, size_t &pos, int &command, int &length) {
+	uint8_t header = input[pos++];
+	command = header >> 5;
+	length = (header & 0x1F) + 1;
+
+	if (command == 0x7) {
+		if (pos >= inputLength) {
+			return false;
+		}
+		command = (header >> 2) & 0x7;
+		length = (((header & 0x3) << 8) | input[pos++]) + 1;
+	}
+	return true;
+}
+
+long lz5DecompressedSize(const uint8_t *input, size_t inputLength, size_t *compressedLength) {
+	size_t pos = 0;
+	long total = 0;
+
+	// We only need to walk the headers to know how much data there is, nothing gets written
+	while (true) {
+		if (pos >= inputLength) {
+			return -1;
+		}
+
+		// 0xFF marks the end of the compressed data
+		if (input[pos] == 0xFF) {
+			pos++;
+			break;
+		}
+
+		int command;
+		int length;
+		if (readHeader(input, inputLength, pos, command, length) == false) {
+			return -1;
+		}
+
+		size_t args = (command == kCmdDirect) ? length : kArgBytes[command];
+		if ((pos + args) > inputLength) {
+			return -1;
+		}
+		pos += args;
+		total += length;
+	}
+
+	if (compressedLength != nullptr) {
+		*compressedLength = pos;
+	}
+	return total;
+}
+
+// Copies from earlier in the output. When the source overlaps the destination it has to go byte by byte, because that repeats the pattern like the game does
+static inline void copyRun(uint8_t *output, size_t address, size_t out, int length, uint8_t flip) {
+	if ((flip == 0) && ((address + length) <= out)) {
+		memcpy(output + out, output + address, length);
+
+	} else {
+		for (int i = 0; i < length; i++) {
+			output[out + i] = output[address + i] ^ flip;
+		}
+	}
+}
+
+long lz5Decompress(const uint8_t *input, size_t inputLength, uint8_t *output, size_t outputCapacity) {
+	size_t pos = 0;
+	size_t out = 0;
+
+	while (true) {
+		if (pos >= inputLength) {
+			return -1;
+		}
+
+		if (input[pos] == 0xFF) {
+			break;
+		}
+
+		int command;
+		int length;
+		if (readHeader(input, inputLength, pos, command, length) == false) {
+			return -1;
+		}
+
+		size_t args = (command == kCmdDirect) ? length : kArgBytes[command];
+		if (((pos + args) > inputLength) || ((out + length) > outputCapacity)) {
+			return -1;
+		}
+
+		const uint8_t *arg = input + pos;
+		uint8_t *dst = output + out;
+		pos += args;
+
+		switch (command) {
+			case kCmdDirect:
+				memcpy(dst, arg, length);
+				break;
+			case kCmdByteFill:
+				memset(dst, arg[0], length);
+				break;
+			case kCmdWordFill:
+				for (int i = 0; i < length; i++) {
+					dst[i] = arg[i & 1];
+				}
+				break;
+			case kCmdIncrement: {
+				uint8_t value = arg[0];
+				for (int i = 0; i < length; i++) {
+					dst[i] = value++;
+				}
+				break;
+			}
+			case kCmdCopy:
+			case kCmdXorCopy: {
+				size_t address = arg[0] | (arg[1] << 8);
+				if (address >= out) {
+					return -1;
+				}
+				copyRun(output, address, out, length, (command == kCmdXorCopy) ? 0xFF : 0x00);
+				break;
+			}
+			case kCmdNegCopy:
+			case kCmdNegXorCopy: {
+				size_t back = arg[0];
+				if ((back == 0) || (back > out)) {
+					return -1;
+				}
+				copyRun(output, out - back, out, length, (command == kCmdNegXorCopy) ? 0xFF : 0x00);
+				break;
+			}
+		}
+		out += length;
+	}
+
+	return out;
+}
+
+bool lz5Decompress(const uint8_t *input, size_t inputLength, std::vector<uint8_t> &output) {
+	// First we find out how big the output is, so that it only gets allocated once
+	size_t used = 0;
+	long size = lz5DecompressedSize(input, inputLength, &used);
+	if (size < 0) {
+		output.clear();
+		return false;
+	}
+
+	output.resize(size);
+	if (size == 0) {
+		return true;
+	}
+	return lz5Decompress(input, used, output.data(), size) == size;
+}
+
+/* The compressor is greedy with one step of lookahead. At every position it
+ * measures each kind of fill, and searches earlier positions for copies
+ * (normal and xor) using a chain of every previous position that started
+ * with the same two bytes. Whichever command saves the most bytes wins,
+ * and anything that can't be saved goes out as direct bytes.
+ */
+struct LZ5Command {
+	int type = kCmdDirect;
+	int length = 0;
+	int arg = 0;
+	int cost = 0;
+
+	int gain() const {
+		return length - cost;
+	}
+};
+
+class LZ5Compressor {
+public:
+	LZ5Compressor(const uint8_t *input, size_t length, int window, int maxChain) : _input(input), _length(length), _window(window), _maxChain(maxChain) {
+		_head.assign(0x10000, -1);
+		_prev.assign(length, -1);
+	}
+
+	void compress(std::vector<uint8_t> &output) {
+		size_t pos = 0;
+		size_t literalStart = 0;
+
+		while (pos < _length) {
+			insertUpTo(pos);
+			LZ5Command command = findBest(pos);
+
+			if (command.gain() > 0) {
+				// If starting one byte later would save noticeably more, we let this byte go out directly instead
+				if ((pos + 1) < _length) {
+					insertUpTo(pos + 1);
+					LZ5Command next = findBest(pos + 1);
+					if (next.gain() > (command.gain() + 1)) {
+						pos++;
+						continue;
+					}
+				}
+
+				writeDirect(output, literalStart, pos);
+				writeCommand(output, command, pos);
+				pos += command.length;
+				literalStart = pos;
+
+			} else {
+				pos++;
+			}
+		}
+
+		writeDirect(output, literalStart, _length);
+		output.push_back(0xFF);
+	}
+
+private:
+	const uint8_t *_input;
+	size_t _length;
+	int _window;
+	int _maxChain;
+	size_t _inserted = 0;
+	std::vector<int> _head;		// The last position that started with each pair of bytes
+	std::vector<int> _prev;		// The position before that with the same pair, for each position
+
+	void insertUpTo(size_t pos) {
+		for (; (_inserted < pos) && ((_inserted + 1) < _length); _inserted++) {
+			int key = _input[_inserted] | (_input[_inserted + 1] << 8);
+			_prev[_inserted] = _head[key];
+			_head[key] = _inserted;
+		}
+	}
+
+	static int headerCost(int type, int length) {
+		return ((length > 32) || (type == kCmdNegXorCopy)) ? 2 : 1;
+	}
+
+	static void consider(LZ5Command &best, int type, int length, int arg, int argBytes) {
+		LZ5Command command;
+		command.type = type;
+		command.length = length;
+		command.arg = arg;
+		command.cost = headerCost(type, length) + argBytes;
+		if (command.gain() > best.gain()) {
+			best = command;
+		}
+	}
+
+	LZ5Command findBest(size_t pos) {
+		LZ5Command best;
+		int remaining = std::min<size_t>(_length - pos, kLZ5MaxLength);
+		const uint8_t *cur = _input + pos;
+		int n;
+
+		// Byte fill
+		n = 1;
+		while ((n < remaining) && (cur[n] == cur[0])) {
+			n++;
+		}
+		consider(best, kCmdByteFill, n, 0, 1);
+
+		// Increasing byte fill
+		n = 1;
+		while ((n < remaining) && (cur[n] == (uint8_t) (cur[0] + n))) {
+			n++;
+		}
+		consider(best, kCmdIncrement, n, 0, 1);
+
+		if (remaining < 2) {
+			return best;
+		}
+
+		// Word fill
+		n = 2;
+		while ((n < remaining) && (cur[n] == cur[n & 1])) {
+			n++;
+		}
+		consider(best, kCmdWordFill, n, 0, 2);
+
+		// And the copies, first normal then inverted
+		for (int flip = 0; flip <= 0xFF; flip += 0xFF) {
+			int key = (cur[0] ^ flip) | ((cur[1] ^ flip) << 8);
+			int candidate = _head[key];
+
+			for (int chain = 0; (candidate >= 0) && (chain < _maxChain); chain++, candidate = _prev[candidate]) {
+				size_t back = pos - candidate;
+				if (back > (size_t) _window) {
+					break;
+				}
+
+				bool negative = back <= kLZ5MaxNegOffset;
+				if ((negative == false) && (candidate > kLZ5MaxAddress)) {
+					continue;
+				}
+
+				const uint8_t *src = _input + candidate;
+				n = 2;
+				while ((n < remaining) && ((uint8_t) (src[n] ^ flip) == cur[n])) {
+					n++;
+				}
+
+				if (flip == 0) {
+					if (negative) {
+						consider(best, kCmdNegCopy, n, back, 1);
+					} else {
+						consider(best, kCmdCopy, n, candidate, 2);
+					}
+
+				} else {
+					// Negative xor copies always need the long header, so an absolute one can be just as cheap
+					if (candidate <= kLZ5MaxAddress) {
+						consider(best, kCmdXorCopy, n, candidate, 2);
+					}
+					if (negative) {
+						consider(best, kCmdNegXorCopy, std::min(n, (int) kLZ5MaxXorLength), back, 1);
+					}
+				}
+
+				if (n == remaining) {
+					break;
+				}
+			}
+		}
+
+		return best;
+	}
+
+	static void writeHeader(std::vector<uint8_t> &output, int type, int length) {
+		length--;
+		if ((length < 32) && (type != kCmdNegXorCopy)) {
+			output.push_back((uint8_t) ((type << 5) | length));
+
+		} else {
+			output.push_back((uint8_t) (0xE0 | (type << 2) | (length >> 8)));
+			output.push_back((uint8_t) (length & 0xFF));
+		}
+	}
+
+	void writeDirect(std::vector<uint8_t> &output, size_t start, size_t end) {
+		while (start < end) {
+			int length = std::min<size_t>(end - start, kLZ5MaxLength);
+			writeHeader(output, kCmdDirect, length);
+			output.insert(output.end(), _input + start, _input + start + length);
+			start += length;
+		}
+	}
+
+	void writeCommand(std::vector<uint8_t> &output, const LZ5Command &command, size_t pos) {
+		writeHeader(output, command.type, command.length);
+		switch (command.type) {
+			case kCmdByteFill:
+			case kCmdIncrement:
+				output.push_back(_input[pos]);
+				break;
+			case kCmdWordFill:
+				output.push_back(_input[pos]);
+				output.push_back(_input[pos + 1]);
+				break;
+			case kCmdCopy:
+			case kCmdXorCopy:
+				output.push_back((uint8_t) (command.arg & 0xFF));
+				output.push_back((uint8_t) (command.arg >> 8));
+				break;
+			case kCmdNegCopy:
+			case kCmdNegXorCopy:
+				output.push_back((uint8_t) command.arg);
+				break;
+		}
+	}
+};
+
+void lz5Compress(const uint8_t *input, size_t length, std::vector<uint8_t> &output, int window, int maxChain) {
+	// Most data compresses to well under half, so this saves a few reallocations
+	output.reserve(output.size() + (length / 2) + 16);
+
+	LZ5Compressor compressor(input, length, window, maxChain);
+	compressor.compress(output);
+}
@@ -0,0 +1,35 @@
+#ifndef RANDO_COMPRESSION_H
+#define RANDO_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* LZ5 compression
+ * Super Metroid stores tile graphics, tilemaps, level data and
+ * tileset palettes all in the same compressed format. These
+ * functions work on plain byte buffers of any size, so they can
+ * be used for any of that data, not just the palettes.
+ */
+enum LZ5Values {
+	kLZ5MaxLength	  = 1024,		// Longest run a single command can describe
+	kLZ5MaxXorLength  = 768,		// Extended negative xor copies can't use the top length bits (that would be 0xFF)
+	kLZ5MaxAddress	  = 0xFFFF,		// Copy commands use a 16bit address into the output
+	kLZ5MaxNegOffset  = 0xFF,		// Negative copy commands use an 8bit offset back from the current position
+	kLZ5DefaultWindow = 0x10000,	// By default the compressor searches every position it can address
+	kLZ5DefaultChain  = 64			// And follows at most this many earlier matches per position
+};
+
+// Returns the size of the decompressed data, or -1 if the data is malformed. If compressedLength is given, it gets the number of input bytes used
+long lz5DecompressedSize(const uint8_t *input, size_t inputLength, size_t *compressedLength = nullptr);
+
+// Decompresses into a preallocated buffer, returning the number of bytes written, or -1 if the data is malformed or doesn't fit
+long lz5Decompress(const uint8_t *input, size_t inputLength, uint8_t *output, size_t outputCapacity);
+
+// Decompresses into a vector sized up front, returning false if the data is malformed
+bool lz5Decompress(const uint8_t *input, size_t inputLength, std::vector<uint8_t> &output);
+
+// Compresses length bytes of input into output (including the 0xFF terminator). Window is how far back the compressor looks for copies
+void lz5Compress(const uint8_t *input, size_t length, std::vector<uint8_t> &output, int window = kLZ5DefaultWindow, int maxChain = kLZ5DefaultChain);
+
+#endif
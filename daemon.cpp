@@ -0,0 +1,565 @@
+// Project Base Randomizer
+// Daemon
+#include "generator.h"
+#include "rom.h"
+#include "parallel.h"
+#include "trace.h"
+
+#include <wx/init.h>
+#include <wx/filename.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <sstream>
+
+/* Daemon
+ * Makes seeds for anything that asks over a unix socket, without the window
+ * and without loading anything again for each one. Each base rom is only read
+ * once, and every worker has its own generator for it, sharing those bytes but
+ * with its own buffer to make seeds in. The generators keep the patches, the
+ * parsed location trees and the enemy palette and FX1 indexes from one seed to
+ * the next, so a request only costs making the seed itself.
+ *
+ * daemon --rom <base rom> [--rom <another base rom>] [--socket <path>] [--workers <n>] [--verbose]
+ *
+ * A request is one setting per line, as the name of a RandoSettings member and
+ * its value, and ends with a line that just says "end". Anything it leaves out
+ * is the same as picking casual. For example:
+ *
+ *   rom <base rom name without the extension, or the first rom if there isn't one>
+ *   seed 1234
+ *   difficulty Very Hard
+ *   shuffleTilePal 1
+ *   hud1 FF8000
+ *   end
+ *
+ * The answer is "ok <patch size> <spoiler size>" on one line, followed by the
+ * ips patch (against the base rom) and then the spoiler log. Or if something
+ * was wrong with the request, just "error <why>". Each connection is one request.
+ *
+ * The client (client.cpp) can make requests with nothing else installed.
+ */
+enum DaemonValues {
+	kDaemonBacklog		= 64,
+	kDaemonMaxRequest	= 0x10000,	// Far longer than any real request
+	kDaemonTimeout		= 10		// How many seconds a client gets to send its request, or take the answer
+};
+
+struct BoolSetting {
+	const char *name;
+	bool RandoSettings::*field;
+};
+
+struct IntSetting {
+	const char *name;
+	int RandoSettings::*field;
+	int max;						// The same as the most the window lets you pick
+};
+
+struct PaletteSetting {
+	const char *name;
+	bool PaletteOptions::*field;
+};
+
+static const BoolSetting kBoolSettings[] = {
+	{"vanilla",				&RandoSettings::vanilla},
+	{"skipCeres",			&RandoSettings::skipCeres},
+	{"mysteryItemGfx",		&RandoSettings::mysteryItemGfx},
+	{"gravityHeat",			&RandoSettings::gravityHeat},
+	{"partyRando",			&RandoSettings::partyRando},
+	{"shuffleTilePal",		&RandoSettings::shuffleTilePal},
+	{"shuffleEnemyPal",		&RandoSettings::shuffleEnemyPal},
+	{"shuffleBeamPal",		&RandoSettings::shuffleBeamPal},
+	{"shuffleSuitPal",		&RandoSettings::shuffleSuitPal},
+	{"generateSuitPal",		&RandoSettings::generateSuitPal},
+	{"includeVanilla",		&RandoSettings::includeVanilla},
+	{"includePBExpanded",	&RandoSettings::includePBExpanded},
+	{"includeHacks",		&RandoSettings::includeHacks},
+	{"shuffleFontNGfx",		&RandoSettings::shuffleFontNGfx},
+	{"shuffleFontTGfx",		&RandoSettings::shuffleFontTGfx},
+	{"majorMinor",			&RandoSettings::majorMinor},
+	{"shuffleFX1",			&RandoSettings::shuffleFX1},
+	{"floodMode",			&RandoSettings::floodMode}
+};
+
+static const IntSetting kIntSettings[] = {
+	{"pauseDefault",		&RandoSettings::pauseDefault,	2},
+	{"hud",					&RandoSettings::hud,			7},
+	{"bomb",				&RandoSettings::bomb,			2},
+	{"energyLow",			&RandoSettings::energyLow,		14},
+	{"energyMed",			&RandoSettings::energyMed,		14},
+	{"energyHigh",			&RandoSettings::energyHigh,		14},
+	{"missilesLow",			&RandoSettings::missilesLow,	50},
+	{"missilesMed",			&RandoSettings::missilesMed,	50},
+	{"missilesHigh",		&RandoSettings::missilesHigh,	50}
+};
+
+// The tileset palette options are in RandoSettings::palette
+static const PaletteSetting kPaletteSettings[] = {
+	{"silhouette",			&PaletteOptions::silhouette},
+	{"continuity",			&PaletteOptions::continuity},
+	{"greyscale",			&PaletteOptions::greyscale}
+};
+
+static void applyDifficulty(RandoSettings &settings, const DifficultyPreset &preset) {
+	settings.gravityHeat = preset.gravityHeat;
+	settings.energyLow = preset.energyLow;
+	settings.energyMed = preset.energyMed;
+	settings.energyHigh = preset.energyHigh;
+	settings.tricks = preset.tricks;
+}
+
+// Numbers can be decimal, or hex with 0x in front
+static bool parseNumber(const std::string &value, unsigned long long &number) {
+	char *end = nullptr;
+	errno = 0;
+	number = strtoull(value.c_str(), &end, 0);
+	return (value != "") && (*end == '\0') && (errno == 0);
+}
+
+static bool parseSetting(RandoSettings &settings, const std::string &name, const std::string &value) {
+	unsigned long long number = 0;
+
+	for (const BoolSetting &setting : kBoolSettings) {
+		if (name == setting.name) {
+			settings.*setting.field = (value == "1") || (value == "true");
+			return (value == "0") || (value == "1") || (value == "true") || (value == "false");
+		}
+	}
+
+	for (const PaletteSetting &setting : kPaletteSettings) {
+		if (name == setting.name) {
+			settings.palette.*setting.field = (value == "1") || (value == "true");
+			return (value == "0") || (value == "1") || (value == "true") || (value == "false");
+		}
+	}
+
+	for (const IntSetting &setting : kIntSettings) {
+		if (name == setting.name) {
+			if ((parseNumber(value, number) == false) || (number > (unsigned long long) setting.max)) {
+				return false;
+			}
+			settings.*setting.field = number;
+			return true;
+		}
+	}
+
+	if (name == "seed") {
+		bool valid = parseNumber(value, number);
+		settings.seed = number;
+		return valid;
+
+	} else if ((name == "options1") || (name == "options2")) {
+		bool valid = parseNumber(value, number) && (number <= 0xFFFF);
+		((name == "options1") ? settings.options1 : settings.options2) = number;
+		return valid;
+
+	} else if (name == "tricks") {
+		bool valid = parseNumber(value, number);
+		settings.tricks = number;
+		return valid;
+
+	// The hud colours are hex, like FF8000
+	} else if ((name == "hud1") || (name == "hud2")) {
+		bool valid = (value.size() == 6) && parseNumber("0x" + value, number);
+		((name == "hud1") ? settings.hud1 : settings.hud2) = Rgb(number >> 16, number >> 8, number);
+		return valid;
+
+	// Sets everything picking that difficulty in the window would (so anything after it can still change those)
+	} else if (name == "difficulty") {
+		for (int d = 0; d < kNumDifficulties; d++) {
+			if (value == kDifficultyPresets[d].name) {
+				applyDifficulty(settings, kDifficultyPresets[d]);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/* Daemon Generator
+ * A generator that keeps one base rom loaded, and gives
+ * back each seed as a patch instead of writing a file
+ */
+class DaemonGenerator : public Generator {
+public:
+	void load(const Rom &base, wxString path);
+	bool warm();
+	bool seed(const RandoSettings &settings, std::vector<wxByte> &patch, std::string &spoiler);
+
+private:
+	wxString _path = "";
+};
+
+void DaemonGenerator::load(const Rom &base, wxString path) {
+	loadRom(base);
+	_path = path;
+}
+
+bool DaemonGenerator::warm() {
+	// One seed with everything turned on, so the indexes and trees are all made before the first request
+	RandoSettings settings;
+	applyDifficulty(settings, kDifficultyPresets[kDifficultyCasual]);
+	settings.shuffleTilePal = true;
+	settings.shuffleEnemyPal = true;
+	settings.shuffleBeamPal = true;
+	settings.shuffleSuitPal = true;
+	settings.shuffleFontNGfx = true;
+	settings.shuffleFontTGfx = true;
+	settings.shuffleFX1 = true;
+
+	std::vector<wxByte> patch;
+	std::string spoiler;
+	return seed(settings, patch, spoiler);
+}
+
+bool DaemonGenerator::seed(const RandoSettings &settings, std::vector<wxByte> &patch, std::string &spoiler) {
+	// Which rom and where the seed goes are up to the daemon, not the request
+	_settings = settings;
+	_settings.basePath = _path;
+	_settings.fileName = "";
+	_log = "";
+
+	bool finished = makeSeed();
+	if (finished == true) {
+		patch = _rom->makePatch();
+		spoiler = _log.ToStdString();
+	}
+
+	// Just like after a seed in the window, the buffer goes back to the base rom for the next one
+	_rom->revert();
+	_log = "";
+	return finished;
+}
+
+struct DaemonRom {
+	wxString name;
+	wxString path;
+	std::unique_ptr<Rom> base;		// Only ever read from, by every worker at once
+};
+
+// Each worker has a generator for every base rom, in the same order as the roms
+struct DaemonWorker {
+	std::vector<std::unique_ptr<DaemonGenerator>> generators;
+	std::thread thread;
+};
+
+// The connections waiting for a worker
+static std::mutex gQueueMutex;
+static std::condition_variable gQueueReady;
+static std::deque<int> gQueue;
+static bool gStopping = false;
+
+// The signal handler writes to this, so the poll in main wakes up even if the signal came just before it
+static int gWakePipe[2] = {-1, -1};
+
+static void onSignal(int signal) {
+	int saved = errno;
+	char byte = 1;
+	if (write(gWakePipe[1], &byte, 1) < 0) {}
+	errno = saved;
+}
+
+static bool writeAll(int client, const void *data, size_t length) {
+	const char *bytes = (const char *) data;
+	while (length > 0) {
+		ssize_t written = write(client, bytes, length);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		bytes += written;
+		length -= written;
+	}
+	return true;
+}
+
+static void replyError(int client, const std::string &error) {
+	TRACE_LOG(kLogWarning, "request failed: " << error);
+	std::string line = "error " + error + "\n";
+	writeAll(client, line.data(), line.size());
+}
+
+// Reads lines until one of them is "end", giving back everything before it
+static bool readRequest(int client, std::string &request) {
+	std::string buffer;
+	char chunk[4096];
+	while (buffer.size() < kDaemonMaxRequest) {
+		size_t end = (buffer.compare(0, 4, "end\n") == 0) ? 0 : buffer.find("\nend\n");
+		if (end != std::string::npos) {
+			request = buffer.substr(0, end);
+			return true;
+		}
+
+		ssize_t got = read(client, chunk, sizeof(chunk));
+		if ((got < 0) && (errno == EINTR)) {
+			continue;
+
+		} else if (got <= 0) {
+			return false;
+		}
+		buffer.append(chunk, got);
+	}
+	return false;
+}
+
+static void serve(int client, DaemonWorker &worker, const std::vector<DaemonRom> &roms) {
+	TRACE_SCOPE("request");
+
+	std::string request;
+	if (readRequest(client, request) == false) {
+		replyError(client, "the request never ended");
+		return;
+	}
+
+	RandoSettings settings;
+	applyDifficulty(settings, kDifficultyPresets[kDifficultyCasual]);
+	size_t rom = 0;
+
+	std::istringstream lines(request);
+	std::string line;
+	while (std::getline(lines, line)) {
+		if (line == "") {
+			continue;
+		}
+
+		size_t space = line.find(' ');
+		std::string name = line.substr(0, space);
+		std::string value = (space != std::string::npos) ? line.substr(space + 1) : "";
+
+		if (name == "rom") {
+			for (rom = 0; (rom < roms.size()) && (roms[rom].name != value); rom++) {}
+			if (rom == roms.size()) {
+				replyError(client, "no base rom called " + value);
+				return;
+			}
+
+		} else if (parseSetting(settings, name, value) == false) {
+			replyError(client, "bad setting: " + line);
+			return;
+		}
+	}
+
+	uint64_t start = traceNow();
+	std::vector<wxByte> patch;
+	std::string spoiler;
+	if (worker.generators[rom]->seed(settings, patch, spoiler) == false) {
+		replyError(client, "the seed was cancelled");
+		return;
+	}
+
+	TRACE_LOG(kLogInfo, "seed " << settings.seed << " on " << roms[rom].name << " in " << ((traceNow() - start) / 1000000.0) << "ms");
+
+	std::string header = wxString::Format("ok %zu %zu\n", patch.size(), spoiler.size()).ToStdString();
+	if ((writeAll(client, header.data(), header.size()) == false) || (writeAll(client, patch.data(), patch.size()) == false)
+		|| (writeAll(client, spoiler.data(), spoiler.size()) == false)) {
+		TRACE_LOG(kLogWarning, "the client went away before getting seed " << settings.seed);
+	}
+}
+
+static void work(DaemonWorker *worker, const std::vector<DaemonRom> *roms) {
+	// There's already a worker for each core, so the parts of a seed that would go wide just run on this one
+	parallelSerial() = true;
+
+	while (true) {
+		int client = -1;
+		{
+			std::unique_lock<std::mutex> lock(gQueueMutex);
+			gQueueReady.wait(lock, []() { return (gStopping == true) || (gQueue.empty() == false); });
+
+			// Anything already waiting still gets its seed before stopping
+			if (gQueue.empty() == true) {
+				return;
+			}
+			client = gQueue.front();
+			gQueue.pop_front();
+		}
+
+		serve(client, *worker, *roms);
+		close(client);
+	}
+}
+
+int main(int argc, char **argv) {
+	wxInitializer initializer;
+	if (initializer.IsOk() == false) {
+		std::cout << "couldn't initialize wxWidgets" << std::endl;
+		return 1;
+	}
+
+	std::vector<DaemonRom> roms;
+	std::string socketPath = "rando.sock";
+	int workers = std::max(1u, std::thread::hardware_concurrency());
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if ((arg == "--rom") && ((i + 1) < argc)) {
+			wxString path = argv[++i];
+			roms.push_back({wxFileName(path).GetName(), path, nullptr});
+
+		} else if ((arg == "--socket") && ((i + 1) < argc)) {
+			socketPath = argv[++i];
+
+		} else if ((arg == "--workers") && ((i + 1) < argc)) {
+			workers = std::max(1, atoi(argv[++i]));
+
+		} else if (arg == "--verbose") {
+			gLogLevel = kLogInfo;
+
+		} else {
+			roms.clear();
+			break;
+		}
+	}
+
+	if (roms.size() == 0) {
+		std::cout << "usage: daemon --rom <base rom> [--rom <another base rom>] [--socket <path>] [--workers <n>] [--verbose]" << std::endl;
+		return 1;
+	}
+
+	// Everything gets loaded before anything can connect, so no request ever waits on it
+	for (DaemonRom &rom : roms) {
+		rom.base.reset(new Rom(rom.path));
+		if (rom.base->isLoaded() == false) {
+			std::cout << "couldn't load the base rom " << rom.path << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<std::unique_ptr<DaemonWorker>> pool;
+	for (int w = 0; w < workers; w++) {
+		pool.emplace_back(new DaemonWorker());
+		for (const DaemonRom &rom : roms) {
+			pool.back()->generators.emplace_back(new DaemonGenerator());
+			pool.back()->generators.back()->load(*rom.base, rom.path);
+		}
+	}
+
+	// The warm up seeds don't touch anything shared, so the workers can all do theirs at once
+	std::vector<char> warmed(workers, 1);
+	for (int w = 0; w < workers; w++) {
+		pool[w]->thread = std::thread([&pool, &warmed, w]() {
+			parallelSerial() = true;
+			for (std::unique_ptr<DaemonGenerator> &generator : pool[w]->generators) {
+				if (generator->warm() == false) {
+					warmed[w] = 0;
+				}
+			}
+		});
+	}
+
+	for (int w = 0; w < workers; w++) {
+		pool[w]->thread.join();
+		if (warmed[w] == 0) {
+			std::cout << "couldn't make a seed with the base roms" << std::endl;
+			return 1;
+		}
+	}
+
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(address.sun_path)) {
+		std::cout << "the socket path is too long: " << socketPath << std::endl;
+		return 1;
+	}
+	strcpy(address.sun_path, socketPath.c_str());
+
+	// Anything left at the path is from a daemon that didn't get to clean up
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	unlink(socketPath.c_str());
+	if ((server < 0) || (bind(server, (sockaddr *) &address, sizeof(address)) < 0) || (listen(server, kDaemonBacklog) < 0)) {
+		std::cout << "couldn't listen on " << socketPath << ": " << strerror(errno) << std::endl;
+		return 1;
+	}
+
+	// Both are nonblocking, so a client that hangs up before the accept can't leave it waiting, and a full pipe can't stop the handler
+	if ((pipe(gWakePipe) < 0) || (fcntl(gWakePipe[1], F_SETFL, O_NONBLOCK) < 0) || (fcntl(server, F_SETFL, O_NONBLOCK) < 0)) {
+		std::cout << "couldn't set up the socket: " << strerror(errno) << std::endl;
+		return 1;
+	}
+
+	// The workers never see the signals, so main is always the one to wake up. And a client hanging up early shouldn't end the daemon
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = onSignal;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+	signal(SIGPIPE, SIG_IGN);
+
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+	for (std::unique_ptr<DaemonWorker> &worker : pool) {
+		worker->thread = std::thread(work, worker.get(), &roms);
+	}
+	pthread_sigmask(SIG_UNBLOCK, &signals, nullptr);
+
+	std::cout << "ready on " << socketPath << " with " << workers << " workers" << std::endl;
+
+	while (true) {
+		pollfd waiting[2] = {{server, POLLIN, 0}, {gWakePipe[0], POLLIN, 0}};
+		if (poll(waiting, 2, -1) < 0) {
+			if (errno != EINTR) {
+				TRACE_LOG(kLogError, "poll failed: " << strerror(errno));
+			}
+			continue;
+		}
+
+		// Anything in the pipe means it's time to stop
+		if (waiting[1].revents != 0) {
+			break;
+		}
+
+		int client = accept(server, nullptr, nullptr);
+		if (client < 0) {
+			if ((errno != EINTR) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+				TRACE_LOG(kLogError, "accept failed: " << strerror(errno));
+			}
+			continue;
+		}
+
+		// The client's socket doesn't get the server's O_NONBLOCK on linux, but it might elsewhere
+		fcntl(client, F_SETFL, fcntl(client, F_GETFL) & ~O_NONBLOCK);
+
+		timeval timeout = {kDaemonTimeout, 0};
+		setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+		std::lock_guard<std::mutex> lock(gQueueMutex);
+		gQueue.push_back(client);
+		gQueueReady.notify_one();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(gQueueMutex);
+		gStopping = true;
+	}
+	gQueueReady.notify_all();
+
+	for (std::unique_ptr<DaemonWorker> &worker : pool) {
+		worker->thread.join();
+	}
+
+	close(server);
+	close(gWakePipe[0]);
+	close(gWakePipe[1]);
+	unlink(socketPath.c_str());
+	return 0;
+}
@@ -0,0 +1,1318 @@
+// Project Base Randomizer
+#include "generator.h"
+#include "rom.h"
+
+#include "colour.h"
+#include "parallel.h"
+#include "trace.h"
+
+#include <cstring>
+
+// The same presets as the difficulty choice in the window, in the same order
+const DifficultyPreset kDifficultyPresets[kNumDifficulties] = {
+	{"Casual",			 true,  1, 3, 5, 0x80000000},
+	{"Normal",			 false, 1, 2, 3, 0x0B000000},
+	{"Speedrunner",		 false, 0, 1, 2, 0x5B000000},
+	{"Hard",			 false, 0, 0, 0, 0x7B000000},
+	{"Very Hard",		 false, 0, 0, 0, 0x7F000000}
+};
+
+Generator::Generator() {
+	// We start by initializing the patches and palettes that we'll be using
+	initializePatches();
+}
+
+void Generator::loadRom(wxString path) {
+	delete _rom;
+	_rom = new Rom(path);
+
+	// Nothing made from the last rom can be put back into this one
+	for (int i = 0; i < kNumStages; i++) {
+		_stages[i].valid = false;
+	}
+}
+
+void Generator::loadRom(const Rom &base) {
+	delete _rom;
+	_rom = new Rom(base);
+
+	for (int i = 0; i < kNumStages; i++) {
+		_stages[i].valid = false;
+	}
+}
+
+// Each part of the seed has its own stream, which only depends on the seed and which part it is
+Rng Generator::stream(RngStream part) {
+	return Rng(_settings.seed).derive(part);
+}
+
+bool Generator::cancelled() {
+	return _cancel == true;
+}
+
+bool Generator::makeSeed() {
+	TRACE_SCOPE("seed");
+
+	TRACE_PHASES(phases);
+
+	// Anything that gets relocated is placed into the free space of whichever map layout we have
+	_rom->initFreeSpace(_settings.vanilla);
+
+	// And begin the log file with the seed value
+	_log += "Super Metroid Project Base 0.8+ Randomizer Spoiler log\n\n";
+	_log += wxString::Format("Seed: %ld\n\n", _settings.seed);
+
+	/* --- Fixes ---
+	 */
+	TRACE_PHASE(phases, "fixes");
+	progress(0, "Applying fixes");
+
+	// This prevents the suit aquired animation from playing, so you can't get stuck from it
+	_rom->setWord(kAddrSuits, 0xEAEA);
+	_rom->setWord(kAddrSuits + 2, 0xEAEA);
+
+	// In vanilla PB, the spore spawn door is green. We want it to be a mini boss door instead, so that you can get out without supers
+	_rom->setWord(kAddrSpore, 0xC84E); // Green door -> locked door
+	_rom->setWord(kAddrSpore + 4, 0x042E); // Index high 00 -> 04 (mini boss of area is dead)
+
+	// This fixes an issue with the original game. In vanilla, chozo orb/hidden morph gives the equipment bit of springball
+	// This just sets it to give morph like it's supposed to
+	_rom->setByte(0x26E02, 0x04);
+	_rom->setByte(0x268CE, 0x04);
+
+	// Haze is removed in PB, this just puts it back in vanilla
+	if (_settings.vanilla == true) {
+		_rom->setByte(0x059C98, 0x88);	// Call to hdma during title screen, in PB this is 93 to deactivate hdma
+		_rom->setByte(0x00924C, 0x88);  // Call to hdma during game over screen, in PB this is 93 to deactivate hdma
+		_rom->setByte(0x045DC7, 0xA9);	// The actual call to the hdma routine for starting haze, in PB this is an RTL
+	}
+
+	// This is to undo all the alternate palettes for tilesets in PB. The palette rando is not taking those into account
+	if (_settings.vanilla == false) {
+		_rom->setByte(0x1bcff, 0x00);
+		_rom->setByte(0x1bd0f, 0x00);
+		_rom->setByte(0x1849f, 0x00);
+		_rom->setByte(0x1c33f, 0x00);
+		_rom->setByte(0x1c27f, 0x00);
+		_rom->setByte(0x18323, 0x00);
+		_rom->setByte(0x19DA3, 0x00);
+		_rom->setByte(0x186AF, 0x00);
+		_rom->setByte(0x1809F, 0x00);
+		_rom->setByte(0x1808F, 0x00);
+		_rom->setByte(0x1806F, 0x00);
+		_rom->setByte(0x19D73, 0x00);
+		_rom->setByte(0x19D83, 0x00);
+		_rom->setByte(0x19D03, 0x00);
+		_rom->setByte(0x19CC3, 0x00);
+		_rom->setByte(0x19CB3, 0x00);
+		_rom->setByte(0x19B11, 0x00);
+		_rom->setByte(0x19B31, 0x00);
+		_rom->setByte(0x19B41, 0x00);
+		_rom->setByte(0x197FF, 0x00);
+		_rom->setByte(0x19C33, 0x00);
+		_rom->setByte(0x19B73, 0x00);
+		_rom->setByte(0x1B2BF, 0x00);
+		_rom->setByte(0x1B2CF, 0x00);
+		_rom->setByte(0x19F83, 0x00);
+		_rom->setByte(0x1BCFF, 0x00);
+		_rom->setByte(0x1BD0F, 0x00);
+	}
+
+	// This one adjusts the event state so that zebes awakens after any (?) item is acquired
+	_rom->applyPatch(_patchEvents);
+
+	// The vanilla patch doesn't include the dash ball gfx, so we need to include it as a patch
+	if (_settings.vanilla == true) {
+		_rom->applyPatch(_patchDashBall);
+	}
+
+	/* --- Options ---
+	 */
+	TRACE_PHASE(phases, "options");
+	progress(5, "Applying options");
+
+	// This will skip the entire intro and ceres station
+	if (_settings.skipCeres == true) {
+		_rom->applyPatch(_patchSkipCeres);
+	}
+
+	if (_settings.mysteryItemGfx == true) {
+		_rom->applyPatch(_gfxMysteryItem);
+	}
+
+	if (_settings.gravityHeat == false) {
+		// If we don't want it to stop heat, we need to change the game code and leave the player object unchanged
+		// Just changes the bit check in samus heat pre-instruction from 21 (varia + gravity) to 01 (varia)
+		// *** Mother brain does a huge amount of damage now?!? But only in vanilla mode? ***
+		_rom->setByte(kAddrHeat, 0x01);
+	}
+
+	if (_settings.partyRando == true) {
+		_rom->applyPatch(_patchEffects);
+	}
+
+	// Set the options to their respective words
+	_rom->setWord(kAddrOptions1, _settings.options1);
+	_rom->setWord(kAddrOptions2, _settings.options2);
+	_rom->setWord(kAddrPause,    _settings.pauseDefault);
+	_rom->setWord(kAddrHud,      _settings.hud);
+	_rom->setWord(kAddrBombTime, _settings.bomb);
+
+	/* --- Stages ---
+	 * Everything from here on is a stage, which only gets made again if something it depends on
+	 * has changed since the last seed. Otherwise it's put back from what it wrote last time.
+	 */
+	const RandoSettings &s = _settings;
+	wxString base = wxString::Format("%s %ld %d", s.basePath, s.seed, s.vanilla);
+
+	// Now all of the palette and gfx shuffling functions
+	if (s.shuffleTilePal == true) {
+		TRACE_PHASE(phases, "tileset palettes");
+		progress(10, "Making tileset palettes");
+		wxString key = base + wxString::Format(" %d %d %d %02X%02X%02X %02X%02X%02X", s.palette.silhouette, s.palette.continuity, s.palette.greyscale,
+											   s.hud1.r, s.hud1.g, s.hud1.b, s.hud2.r, s.hud2.g, s.hud2.b);
+		if (runStage(kStageTilePalettes, key, [&]() { makeNewTilesetPalettes(); }) == false) { return false; }
+	}
+
+	if ((s.shuffleEnemyPal == true) || (s.shuffleBeamPal == true) || (s.shuffleSuitPal == true)) {
+		TRACE_PHASE(phases, "palettes");
+		progress(35, "Shuffling palettes");
+		wxString key = base + wxString::Format(" %d %d %d %d %d %d %d", s.shuffleEnemyPal, s.shuffleBeamPal, s.shuffleSuitPal, s.generateSuitPal,
+											   s.includeVanilla, s.includePBExpanded, s.includeHacks);
+		if (runStage(kStagePalettes, key, [&]() {
+			if (s.shuffleEnemyPal == true) { shuffleEnemyPalettes(); }
+			if (s.shuffleBeamPal == true) { shuffleBeamPalettes(); }
+			if (s.shuffleSuitPal == true) { shuffleSuitPalettes(); }
+		}) == false) { return false; }
+	}
+
+	if ((s.shuffleFontNGfx == true) || (s.shuffleFontTGfx == true)) {
+		TRACE_PHASE(phases, "fonts");
+		progress(40, "Shuffling fonts");
+		wxString key = base + wxString::Format(" %d %d", s.shuffleFontNGfx, s.shuffleFontTGfx);
+		if (runStage(kStageFonts, key, [&]() {
+			if (s.shuffleFontNGfx == true) { shuffleFontNumbers(); }
+			if (s.shuffleFontTGfx == true) { shuffleFontText(); }
+		}) == false) { return false; }
+	}
+
+	/* --- Logic ---
+	 */ 
+	TRACE_PHASE(phases, "items");
+	progress(45, "Placing items");
+
+	// Now the actual rando logic itself, which calls from a separate file to ensure logic is separate from the rest of the program
+	resetPlayer();
+
+	// Where the items went (_placed) is kept from the last time the logic ran, so flood mode can still use it when this stage is put back
+	wxString items = base + wxString::Format(" %llx %d %d %d %d %d %d %d", (unsigned long long) s.tricks, s.majorMinor, s.energyLow, s.energyMed,
+											 s.energyHigh, s.missilesLow, s.missilesMed, s.missilesHigh);
+	if (runStage(kStageItems, items, [&]() { logic(); }) == false) { return false; }
+
+	// The FX come after the logic, because flood mode needs to know where everything ended up
+	// And shuffle FX1 needs to happen before flood mode for obvious reasons
+	if ((s.shuffleFX1 == true) || (s.floodMode == true)) {
+		TRACE_PHASE(phases, "fx");
+		progress(80, "Placing FX");
+		wxString key = items + wxString::Format(" %d %d", s.shuffleFX1, s.floodMode);
+		if (runStage(kStageFX, key, [&]() {
+			if (_fx1Path != s.basePath) {
+				indexFX1();
+				indexFX1Rooms();
+				_fx1Path = s.basePath;
+			}
+
+			std::vector<FX1Entry> fx1 = _fx1Entries;
+			if (s.shuffleFX1 == true) { shuffleFX1(fx1); }
+			if (s.floodMode == true) { floodFX1(fx1); }
+			writeFX1(fx1);
+		}) == false) { return false; }
+	}
+
+	/* --- Output ---
+	 */
+	if (cancelled() == true) { return false; }
+	TRACE_PHASE(phases, "write rom");
+	progress(95, "Writing rom");
+
+	// Make a new file that will be the output rom using the current data buffer (unless whatever wanted the seed takes it straight from the buffer)
+	if (_settings.fileName != "") {
+		_rom->makeNewRom(_settings.fileName);
+	}
+	return true;
+}
+
+// The player starts out with the tricks, and the energy and missile amounts the logic should expect
+void Generator::resetPlayer() {
+	_player = Player();
+	_player.collected |= _settings.tricks;
+	_player.majorMinor = _settings.majorMinor;
+	_player.energyLow = _settings.energyLow;
+	_player.energyMed = _settings.energyMed;
+	_player.energyHigh = _settings.energyHigh;
+	_player.missilesLow = _settings.missilesLow;
+	_player.missilesMed = _settings.missilesMed;
+	_player.missilesHigh = _settings.missilesHigh;
+}
+
+// What each stage shows up as in a trace
+static const char *kStageNames[kNumStages] = {"stage: tileset palettes", "stage: palettes", "stage: fonts", "stage: items", "stage: fx"};
+
+bool Generator::runStage(int stage, wxString key, std::function<void()> make) {
+	TRACE_SCOPE(kStageNames[stage]);
+	StageCache &cache = _stages[stage];
+
+	// The free space left by the stages before this one matters too, since it might need some
+	for (const FreeRegion &region : _rom->_freeSpace) {
+		key += wxString::Format(" %llx-%llx", (unsigned long long) region.start, (unsigned long long) region.end);
+	}
+
+	if ((cache.valid == true) && (cache.key == key)) {
+		TRACE_SCOPE("replay");
+		_rom->replay(cache.writes);
+		_rom->_freeSpace = cache.freeSpace;
+		_log += cache.log;
+		return true;
+	}
+
+	cache.valid = false;
+	cache.writes.clear();
+
+	size_t logStart = _log.length();
+	_rom->_journal = &cache.writes;
+	make();
+	_rom->_journal = nullptr;
+
+	// A stage that was cancelled partway through isn't any good to keep
+	if (cancelled() == true) {
+		return false;
+	}
+
+	cache.key = key;
+	cache.freeSpace = _rom->_freeSpace;
+	cache.log = _log.Mid(logStart);
+	cache.valid = true;
+	return true;
+}
+
+void Generator::indexFX1() {
+	TRACE_SCOPE("indexFX1");
+
+	_fx1Entries.clear();
+
+	const wxByte *rom = _rom->_dataBuffer;
+	uint64_t listStart = kAddrFX1Start;
+	uint64_t i = kAddrFX1Start;
+	while (i < kAddrFX1End) {
+		// A room with no FX only has the FFFF, and then the next list starts right after it
+		if (rom[i] == kFX1NoFX) {
+			i += 2;
+			listStart = i;
+			continue;
+		}
+
+		FX1Entry entry;
+		entry.offset = i;
+		entry.list = Rom::pcToSnes(listStart) & 0xFFFF;
+		entry.door = rom[i] | (rom[i + 1] << 8);
+		entry.baseY = rom[i + 2] | (rom[i + 3] << 8);
+		entry.targetY = rom[i + 4] | (rom[i + 5] << 8);
+		entry.velocity = rom[i + 6] | (rom[i + 7] << 8);
+		entry.timer = rom[i + 8];
+		entry.type = rom[i + 9];
+		entry.layerA = rom[i + 10];
+		entry.layerB = rom[i + 11];
+		entry.liquidOptions = rom[i + 12];
+		entry.paletteFX = rom[i + 13];
+		entry.animatedTiles = rom[i + 14];
+		entry.blend = rom[i + 15];
+		_fx1Entries.push_back(entry);
+
+		i += kFX1EntrySize;
+		if (entry.door == 0) {
+			listStart = i;
+		}
+	}
+}
+
+void Generator::writeFX1(const std::vector<FX1Entry> &entries) {
+	TRACE_SCOPE("writeFX1");
+
+	// Only the fields that are different from the base rom get written
+	for (size_t e = 0; e < entries.size(); e++) {
+		const FX1Entry &entry = entries[e];
+		const FX1Entry &base = _fx1Entries[e];
+		uint64_t i = entry.offset;
+
+		if (entry.baseY != base.baseY) { _rom->setWord(i + 2, entry.baseY); }
+		if (entry.targetY != base.targetY) { _rom->setWord(i + 4, entry.targetY); }
+		if (entry.velocity != base.velocity) { _rom->setWord(i + 6, entry.velocity); }
+		if (entry.timer != base.timer) { _rom->setByte(i + 8, entry.timer); }
+		if (entry.type != base.type) { _rom->setByte(i + 9, entry.type); }
+		if (entry.layerA != base.layerA) { _rom->setByte(i + 10, entry.layerA); }
+		if (entry.layerB != base.layerB) { _rom->setByte(i + 11, entry.layerB); }
+		if (entry.liquidOptions != base.liquidOptions) { _rom->setByte(i + 12, entry.liquidOptions); }
+		if (entry.paletteFX != base.paletteFX) { _rom->setByte(i + 13, entry.paletteFX); }
+		if (entry.animatedTiles != base.animatedTiles) { _rom->setByte(i + 14, entry.animatedTiles); }
+		if (entry.blend != base.blend) { _rom->setByte(i + 15, entry.blend); }
+	}
+}
+
+int readRoomStates(const wxByte *rom, uint64_t header, uint64_t states[kRoomMaxStates]) {
+	int width = rom[header + 4];
+	int height = rom[header + 5];
+	uint16_t doors = rom[header + 9] | (rom[header + 10] << 8);
+	if ((rom[header + 1] > 7) || (width == 0) || (width > kRoomMaxSize) || (height == 0) || (height > kRoomMaxSize) || (doors < kLoRomBankSize)) {
+		return 0;
+	}
+
+	int numStates = 0;
+	uint64_t q = header + kRoomHeaderSize;
+	while ((numStates < kRoomMaxStates) && ((q + 2 + kRoomStateSize) < kAddrRoomsEnd)) {
+		uint16_t code = rom[q] | (rom[q + 1] << 8);
+		int args = 0;
+		switch (code) {
+			case kStateDefault:
+				// The default state comes right after its code, and is always the last one
+				states[numStates++] = q + 2;
+				return numStates;
+			case kStateDoor:
+				args = 2;
+				break;
+			case kStateEvent:
+			case kStateBoss:
+				args = 1;
+				break;
+			case kStateMainBoss:
+			case kStateMorph:
+			case kStateMorphMissiles:
+			case kStatePowerBombs:
+			case kStateSpeedBooster:
+				break;
+			default:
+				return 0;
+		}
+
+		uint16_t pointer = rom[q + 2 + args] | (rom[q + 3 + args] << 8);
+		states[numStates++] = Rom::snesToPc(0x8F0000 | pointer);
+		q += 4 + args;
+	}
+	return 0;
+}
+
+void Generator::indexFX1Rooms() {
+	TRACE_SCOPE("indexFX1Rooms");
+
+	_fx1Rooms.clear();
+
+	// The entries are in order, so each list is a run of them
+	for (const FX1Entry &entry : _fx1Entries) {
+		if ((_fx1Rooms.size() == 0) || (_fx1Rooms.back().list != entry.list)) {
+			FX1Room room;
+			room.list = entry.list;
+			_fx1Rooms.push_back(room);
+		}
+	}
+
+	/* There's no list of rooms, so we look through the bank for anything that is laid out like a
+	 * room header, with state conditions we know, ending in a default state that uses a tileset
+	 * that exists and one of the FX1 lists. Nothing else in the bank gets through all of that.
+	 */
+	const wxByte *rom = _rom->_dataBuffer;
+	for (uint64_t p = kAddrRoomsStart; (p + kRoomHeaderSize) < kAddrRoomsEnd; p++) {
+		uint64_t states[kRoomMaxStates];
+		int numStates = readRoomStates(rom, p, states);
+		if (numStates == 0) {
+			continue;
+		}
+
+		int height = rom[p + 5];
+		bool valid = true;
+
+		// And every state has to look like a state
+		for (int s = 0; (s < numStates) && (valid == true); s++) {
+			uint64_t state = states[s];
+			uint16_t fx1 = rom[state + kRoomStateFX1] | (rom[state + kRoomStateFX1 + 1] << 8);
+			std::vector<FX1Room>::iterator room = std::lower_bound(_fx1Rooms.begin(), _fx1Rooms.end(), fx1, [](const FX1Room &r, uint16_t list) {
+				return r.list < list;
+			});
+			if (((state + kRoomStateSize) > kAddrRoomsEnd) || (rom[state + kRoomStateTileset] >= kNumTilesets) || (room == _fx1Rooms.end()) || (room->list != fx1)) {
+				valid = false;
+			}
+		}
+		if (valid == false) {
+			continue;
+		}
+
+		for (int s = 0; s < numStates; s++) {
+			addRoomState(states[s], height);
+		}
+		p = states[numStates - 1] + kRoomStateSize - 1;
+	}
+
+	// Rooms share PLM sets between states, so the same location can come up more than once
+	for (FX1Room &room : _fx1Rooms) {
+		std::sort(room.locations.begin(), room.locations.end());
+		room.locations.erase(std::unique(room.locations.begin(), room.locations.end()), room.locations.end());
+	}
+}
+
+void Generator::addRoomState(uint64_t state, int height) {
+	const wxByte *rom = _rom->_dataBuffer;
+	uint16_t fx1 = rom[state + kRoomStateFX1] | (rom[state + kRoomStateFX1 + 1] << 8);
+	FX1Room &room = *std::lower_bound(_fx1Rooms.begin(), _fx1Rooms.end(), fx1, [](const FX1Room &r, uint16_t list) {
+		return r.list < list;
+	});
+	room.height = std::max(room.height, height);
+
+	// Every PLM in the set goes in, the item locations are the ones the logic knows about
+	uint16_t plm = rom[state + kRoomStatePLM] | (rom[state + kRoomStatePLM + 1] << 8);
+	for (uint64_t i = Rom::snesToPc(0x8F0000 | plm); (i + kPLMEntrySize) <= kAddrRoomsEnd; i += kPLMEntrySize) {
+		if ((rom[i] | rom[i + 1]) == 0) {
+			break;
+		}
+		room.locations.push_back(i);
+	}
+}
+
+void Generator::shuffleFX1(std::vector<FX1Entry> &entries) {
+	TRACE_SCOPE("shuffleFX1");
+
+	Rng rng = stream(kStreamFX);
+	for (FX1Entry &entry : entries) {
+		wxByte type = entry.type;
+		if (type <= kFX1TypeLast) {
+			if ((type > 0) && (type < 8)) {
+				// Type is a liquid, so choose only liquids to replace it with
+				wxByte randLiquid = type;
+
+				// We want it to always pick a new type
+				while (randLiquid == type) {
+					randLiquid = (rng.below(3) * 2) + 2;
+				}
+
+				entry.type = randLiquid;
+
+				switch (randLiquid) {
+					case 0x02:
+						// For lava, we want to make the blend 0x02
+						entry.blend = 0x02;
+						break;
+					case 0x04:
+						// Acid doesn't really need a blend because it uses the yellow in the tileset
+						entry.blend = 0x48;
+						break;
+					case 0x06:
+						// But water does need a colour, so we'll use 0x48 for now
+						entry.blend = 0x48;
+					default:
+						break;
+				}
+
+			} else {
+				wxByte randOption = type;
+
+				// We want it to always pick a new type
+				while (randOption == type) {
+					randOption = (rng.below(3) * 2) + 8;
+				}
+
+				entry.type = randOption;
+
+				switch (randOption) {
+					case 0x08:
+						// For spores, we want a blend and also movement
+						entry.blend = 0x48;
+						entry.baseY = 0xFFC0;
+						break;
+					case 0x0A:
+						// Rain is pretty simple
+						entry.blend = 0x22;
+						break;
+					case 0x0C:
+						// Fog has a lot of good blend options, might need to tweak this
+						entry.blend = 0x62;
+						entry.baseY = 0xFFF0;
+						entry.targetY = 0x0060;
+						break;
+					default:
+						break;
+				}
+			}
+		}
+	}
+}
+
+/* Tileset palette templates
+ * Each template is the list of colours that make up a tileset palette, and how each one gets picked.
+ * These never change, so they're compile time tables, and anything that does change for a seed is
+ * worked out in processTilesetTemplate without touching them.
+ */
+// PB
+static constexpr PalColour kTemplate1[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjNone, kRelNone, -1, 1, 3, 80, 30), PalColour(0x44, kObjNone, kRelTriadic, 0x41, 0.7f, 3, 110, 30, 10.0), PalColour(0x47, kObjNone, kRelNone, 0x46, 1, 0, 20, -1), PalColour(0x48, kObjNone, kRelAnalogous, 0x44, 0.7f, 4, 100, 20), PalColour(0x4C, 0x41, 120), PalColour(0x51, kObjMetal, kRelNone, -1, 1, 3, 80, 30), PalColour(0x58, kObjNone, kRelCompliment, 0x48, 1, 4, 100, 30), PalColour(0x5C, 0x53, 60), PalColour(0x61, 0x41, 3, 50, 1), PalColour(0x64, kObjNone, kRelTriadic, 0x44, 0.5f, 4, 40, 1), PalColour(0x68, 0x48, 4, 50, 1), PalColour(0x6C, 0x4C, 60), PalColour(0x74, kObjStone, kRelNone, -1, 1, 4, 100, 30), PalColour(0x78, 0x48, 4, 100, 30)};
+static constexpr PalColour kTemplate2[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x34, kObjMetal, kRelNone, -1, 0.7f, 4, 50, 5), PalColour(0x34, kObjNone, kRelNone, -1, 0.7f, 4, 30, 5), PalColour(0x3E, 0x34, 110), PalColour(0x41, kObjNone, kRelNone, -1, 1, 3, 80, 30), PalColour(0x44, kObjNone, kRelTriadic, 0x41, 0.7f, 3, 110, 30, 10.0), PalColour(0x47, kObjNone, kRelNone, 0x46, 1, 0, 20, -1), PalColour(0x48, kObjNone, kRelAnalogous, 0x44, 0.7f, 4, 100, 20), PalColour(0x4C, 0x41, 120), PalColour(0x4D, 0x4C, 60), PalColour(0x4E, 0x4C, 100), PalColour(0x51, kObjMetal, kRelNone, -1, 0.4f, 3, 80, 40), PalColour(0x57, kRgbBlack), PalColour(0x58, kObjNone, kRelCompliment, 0x48, 0.8f, 4, 80, 20, 10.0), PalColour(0x5C, 0x53, 70), PalColour(0x61, 0x41, 3, 60, 5), PalColour(0x64, 0x44, 4, 60, 5), PalColour(0x68, 0x48, 4, 60, 5), PalColour(0x6C, 0x4C, 50), PalColour(0x6E, 0x4E, 50), PalColour(0x71, 0x41, 3, 80, 30), PalColour(0x74, kObjMetal, kRelNone, 0x74, 1, 4, 100, 30, 0, 0), PalColour(0x78, 0x48, 4, 100, 20), PalColour(0x7C, kObjNatural, kRelNone, -1, 1, 0, 80, -1), PalColour(0x7D, 0x7C, 120)};
+static constexpr PalColour kTemplate3[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjNone, kRelNone, -1, 0.7f, 3, 80, 30), PalColour(0x44, kObjNone, kRelCompliment, 0x41, 0.7f, 4, 80, 20, 10.0), PalColour(0x48, kObjNatural, kRelNone, -1, 1, 2, 100, 70), PalColour(0x4A, kObjNone, kRelAnalogous, 0x48, 1, 2, 70, 40), PalColour(0x4E, 0x41, 110), PalColour(0x51, 0x41, 3, 60, 5), PalColour(0x54, kObjMetal, kRelNone, -1, 1, 4, 40, 5, 10.0), PalColour(0x58, kObjNatural, kRelNone, -1, 1, 2, 100, 80), PalColour(0x5A, 0x4A, 2, 100, 40), PalColour(0x5C, 0x53, 30), PalColour(0x5D, 0x58, 120), PalColour(0x5E, 0x51, 120), PalColour(0x61, kObjMetal, kRelNone, -1, 0.7f, 3, 80, 30), PalColour(0x64, 0x54, 4, 100, 30), PalColour(0x68, kObjMetal, kRelNone, -1, 1, 4, 60, 5), PalColour(0x71, 0x51, 3, 80, 20), PalColour(0x74, 0x54, 3, 120, 80), PalColour(0x78, kObjMetal, kRelNone, -1, 1, 4, 100, 20), PalColour(0x7E, 0x71, 120)};
+static constexpr PalColour kTemplate4[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjNone, kRelNone, -1, 0.7f, 3, 80, 30), PalColour(0x44, kObjNone, kRelNone, 0x44, 0.7f, 4, 80, 20, 10.0, 0), PalColour(0x48, kObjNatural, kRelNone, -1, 1, 2, 100, 70), PalColour(0x4B, kObjNone, kRelAnalogous, 0x48, 1, -2, 70, 40), PalColour(0x4E, 0x41, 110), PalColour(0x51, 0x41, 3, 60, 5), PalColour(0x54, kObjMetal, kRelNone, -1, 1, 4, 40, 5, 10.0), PalColour(0x58, kObjNatural, kRelNone, -1, 1, 2, 100, 80), PalColour(0x5A, 0x4A, 2, 100, 40), PalColour(0x5C, 0x53, 30), PalColour(0x5D, 0x58, 120), PalColour(0x5E, 0x51, 120), PalColour(0x61, kObjMetal, kRelNone, -1, 0.7f, 3, 80, 30), PalColour(0x64, 0x54, 4, 100, 30), PalColour(0x68, kObjMetal, kRelNone, -1, 1, 4, 60, 5), PalColour(0x71, 0x51, 3, 80, 20), PalColour(0x74, 0x54, 3, 120, 80), PalColour(0x78, kObjMetal, kRelNone, -1, 1, 4, 100, 20), PalColour(0x7E, 0x71, 120)};
+static constexpr PalColour kTemplate5[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjNatural, kRelNone, 0x41, 1, 3, 70, 30, 0, 0), PalColour(0x44, kObjMetal, kRelNone, 0x74, 1, 4, 70, 10, 0, 0), PalColour(0x48, kObjNone, kRelCompliment, 0x44, 1, 4, 80, 10), PalColour(0x4C, kObjNone, kRelNone, 0x79, 1, 0, 100, -1, 0, 0), PalColour(0x4D, kObjNone, kRelNone, 0x78, 1, 0, 100, -1, 0, 0), PalColour(0x4E, 0x44, 120), PalColour(0x51, 0x41, 3, 40, 5), PalColour(0x54, 0x44, 4, 40, 5), PalColour(0x58, kObjNone, kRelCompliment, 0x44, 1, 4, 120, 40), PalColour(0x71, kObjMetal, kRelNone, -1, 1, 3, 20, 5), PalColour(0x74, kObjMetal, kRelNone, -1, 1, 4, 20, 5), PalColour(0x78, kObjMetal, kRelNone, -1, 1, 4, 20, 5), PalColour(0x7D, kObjNatural, kRelNone, -1, 1, -2, 80, 60)};
+static constexpr PalColour kTemplate6[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjNatural, kRelNone, -1, 1, 3, 70, 30, 0), PalColour(0x44, kObjMetal, kRelNone, 0x74, 1, 4, 70, 10, 0, 0), PalColour(0x48, kObjNone, kRelCompliment, 0x44, 1, 4, 80, 10), PalColour(0x4C, kObjNone, kRelNone, 0x79, 1, 0, 100, -1, 0, 0), PalColour(0x4D, kObjNone, kRelNone, 0x78, 1, 0, 100, -1, 0, 0), PalColour(0x4E, 0x44, 120), PalColour(0x51, 0x41, 3, 60, 5), PalColour(0x54, 0x44, 4, 60, 5), PalColour(0x58, kObjNone, kRelCompliment, 0x44, 1, 4, 120, 40), PalColour(0x71, kObjMetal, kRelNone, -1, 1, 3, 40, 5), PalColour(0x74, kObjMetal, kRelNone, -1, 1, 4, 40, 5), PalColour(0x78, kObjMetal, kRelNone, -1, 1, 4, 40, 5), PalColour(0x7D, kObjNatural, kRelNone, -1, 1, -2, 80, 60)};
+static constexpr PalColour kTemplate7[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x28, kObjNatural, kRelNone, -1, 1, 4, 50, 5), PalColour(0x2C, Rgb(227,194,212)), PalColour(0x31, kObjNatural, kRelNone, -1, 1, 7, 60, 10), PalColour(0x48, kObjNatural, kRelNone, -1, 0.8f, 3, 100, 60), PalColour(0x44, kObjNone, kRelNone, 0x49, 1, 4, 80, 10, 10.0), PalColour(0x43, 0x46, 80), PalColour(0x4C, 0x48, 100), PalColour(0x4E, 0x4C, 110), PalColour(0x51, kObjNatural, kRelNone, -1, 1, 3, 100, 60, 10.0), PalColour(0x54, kObjNone, kRelNone, 0x4C, 0.7f, 4, 100, 60, 10.0), PalColour(0x58, 0x54, 40), PalColour(0x24, 0x54, 4, 100, 20), PalColour(0x61, kObjNatural, kRelNone, -1, 0.6f, 7, 90, 5), PalColour(0x68, kObjNone, kRelCompliment, 0x61, 1, 4, 100, 5), PalColour(0x71, kObjNone, kRelCompliment, 0x61, 1, 3, 100, 5), PalColour(0x74, 0x72, 4, 60, 5)};
+static constexpr PalColour kTemplate8[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x31, kObjNatural, kRelNone, -1, 1, 7, 60, 10), PalColour(0x3C, 0x31, 110), PalColour(0x3D, 0x33, 140), PalColour(0x3E, kObjNatural, kRelNone, -1, 1, 0, 100, -1), PalColour(0x41, kObjNone, kRelNone, -1, 1, 3, 100, 50, 20.0), PalColour(0x44, kObjNone, kRelNone, 0x41, 0.8f, 8, 90, 1), PalColour(0x4C, 0x41, 100), PalColour(0x53, kObjMetal, kRelNone, -1, 0.4f, 5, 100, 5), PalColour(0x58, kObjNone, kRelNone, -1, 1, 4, 100, 20, 20.0), PalColour(0x5C, 0x53, 30), PalColour(0x61, kObjNatural, kRelNone, -1, 1, 0, 100, -1), PalColour(0x64, 0x61, 8, 100, 5), PalColour(0x6C, 0x61, 120), PalColour(0x71, kObjNone, kRelNone, -1, 1, 4, 100, 40), PalColour(0x75, 0x73, 3, 100, 5), PalColour(0x78, kObjNone, kRelCompliment, 0x71, 1, 3, 100, 50, 20.0), PalColour(0x7B, 0x77, 90), PalColour(0x7C, 0x71, 120), PalColour(0x7D, 0x73, 100), PalColour(0x7E, 0x71, 110)};
+static constexpr PalColour kTemplate10[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x34, kObjNatural, kRelNone, -1, 1, 4, 100, 50, 10.0), PalColour(0x38, kObjMetal, kRelNone, -1, 1, 4, 100, 5), PalColour(0x3C, 0x35, 100), PalColour(0x3D, 0x39, 100), PalColour(0x41, kObjNatural, kRelNone, -1, 1, 3, 100, 70, 10.0), PalColour(0x44, kObjNone, kRelNone, -1, 1, 4, 100, 20), PalColour(0x48, kObjNone, kRelNone, -1, 0.7f, 3, 100, 40), PalColour(0x4B, 0x4A, 10), PalColour(0x4C, 0x45, 100), PalColour(0x4D, kObjNone, kRelAnalogous, 0x48, 1, 0, 120, -1), PalColour(0x51, 0x41, 3, 100, 70, 10.0), PalColour(0x54, kObjStone, kRelNone, -1, 0.7f, 4, 80, 5), PalColour(0x58, kObjNone, kRelNone, -1, 1, 4, 100, 5), PalColour(0x5C, 0x55, 100), PalColour(0x5D, 0x59, 100), PalColour(0x5E, 0x4B, 100), PalColour(0x61, 0x41, 3, 50, 20, 10.0), PalColour(0x64, 0x54, 4, 50, 20), PalColour(0x68, 0x58, 4, 50, 20), PalColour(0x6C, 0x5C, 40), PalColour(0x6D, 0x5D, 40), PalColour(0x71, 0x41, 3, 70, 20, 10.0), PalColour(0x74, 0x54, 4, 60, 5), PalColour(0x78, 0x58, 4, 60, 5), PalColour(0x7C, 0x68, 90), PalColour(0x7D, 0x68, 110)};
+static constexpr PalColour kTemplate11[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x24, kObjStone, kRelNone, -1, 0.8, 4, 100, 20, 20.0), PalColour(0x28, kObjNatural, kRelNone, -1, 1, 4, 100, 40, 10.0), PalColour(0x34, 0x28, 4, 100, 40, 10.0), PalColour(0x38, kObjMetal, kRelNone, -1, 1, 4, 100, 5, 10.0), PalColour(0x3C, 0x35, 100), PalColour(0x3D, 0x39, 100), PalColour(0x41, 0x29, 3, 100, 60, 10.0), PalColour(0x44, kObjNatural, kRelNone, -1, 1, 4, 100, 20), PalColour(0x48, kObjNone, kRelTriadic, 0x44, 0.7f, 3, 100, 40), PalColour(0x4B, 0x4A, 10), PalColour(0x4C, 0x45, 100), PalColour(0x4D, kObjNone, kRelAnalogous, 0x48, 1, 0, 120, -1), PalColour(0x54, kObjNone, kRelAnalogous, 0x24, 0.7f, 4, 80, 5, 20.0), PalColour(0x51, 0x56, 3, 90, 50, 10.0), PalColour(0x58, kObjNone, kRelTriadic, 0x48, 1, 4, 100, 5), PalColour(0x5C, 0x55, 100), PalColour(0x5D, 0x59, 100), PalColour(0x5E, 0x4B, 100), PalColour(0x61, 0x29, 3, 60, 20, 10.0), PalColour(0x64, 0x54, 4, 60, 20), PalColour(0x68, 0x58, 4, 60, 20), PalColour(0x6C, 0x5C, 50), PalColour(0x6D, 0x5D, 50), PalColour(0x71, 0x29, 3, 60, 20, 10.0), PalColour(0x74, kObjNone, kRelAnalogous, 0x54, 1, 4, 40, 5, 20.0), PalColour(0x78, 0x58, 4, 40, 5), PalColour(0x7C, 0x68, 90), PalColour(0x7D, 0x68, 110)};
+static constexpr PalColour kTemplate12[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x24, kObjStone, kRelNone, -1, 0.6f, 8, 100, 30, 5.0), PalColour(0x2C, 0x04, 100), PalColour(0x2D, 0x05, 100), PalColour(0x34, kObjNatural, kRelNone, -1, 0.7f, 4, 60, 5, 5.0), PalColour(0x38, kObjNone, kRelAnalogous, 0x34, 4, 60, 20, 5.0), PalColour(0x3C, 0x38, 130), PalColour(0x3E, 0x3C, 150), PalColour(0x41, kObjNone, kRelNone, -1, 0.8f, 3, 70, 30, 5.0), PalColour(0x44, 0x28, 4, 100, 30), PalColour(0x48, kObjNone, kRelTriadic, 0x41, 1, 4, 140, 20, 15.0), PalColour(0x4D, 0x41, 150), PalColour(0x51, kObjNone, kRelNone, -1, 1, 3, 100, 20), PalColour(0x54, kObjNone, kRelTriadic, 0x48, 1, 4, 100, 5, 5.0), PalColour(0x5B, kObjNone, kRelCompliment, 0x54, 1, -4, 100, 10, 10.0), PalColour(0x5D, 0x58, 50), PalColour(0x68, 0x58, 4, 100, 5), PalColour(0x6C, 0x69, 100), PalColour(0x74, 0x54, 4, 100, 20), PalColour(0x78, kObjGlass, kRelNone, -1, 1, 6, 100, 20, 10.0), PalColour(0x7E, 0x77, 60)};
+static constexpr PalColour kTemplate13[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x24, kObjStone, kRelNone, -1, 0.6f, 8, 100, 30, 5.0), PalColour(0x2C, 0x04, 100), PalColour(0x2D, 0x05, 100), PalColour(0x37, kObjNatural, kRelNone, -1, 0.7f, -4, 60, 5, 5.0), PalColour(0x38, kObjNone, kRelAnalogous, 0x34, 4, 60, 20, 5.0), PalColour(0x3C, 0x38, 130), PalColour(0x3E, 0x3C, 150), PalColour(0x41, kObjNone, kRelNone, -1, 0.8f, 3, 70, 30, 5.0), PalColour(0x44, 0x28, 4, 100, 30), PalColour(0x48, kObjNone, kRelTriadic, 0x41, 1, 4, 140, 20, 15.0), PalColour(0x4D, 0x41, 150), PalColour(0x51, kObjNone, kRelNone, -1, 1, 3, 100, 20), PalColour(0x54, kObjNone, kRelTriadic, 0x48, 1, 4, 100, 5, 5.0), PalColour(0x5B, kObjNone, kRelCompliment, 0x54, 1, -4, 100, 10, 10.0), PalColour(0x5D, 0x58, 50), PalColour(0x68, 0x58, 4, 100, 5), PalColour(0x6C, 0x69, 100), PalColour(0x74, kObjNone, kRelNone, -1, 1, 4, 100, 20), PalColour(0x78, kObjGlass, kRelNone, -1, 1, 6, 100, 20, 10.0), PalColour(0x7E, 0x77, 60)};
+static constexpr PalColour kTemplate14[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x24, true, kObjNone, kRelNone, -1, 1, 4, 100, 30, 10.0), PalColour(0x28, true, kObjNone, kRelNone, -1, 1, 4, 50, 1), PalColour(0x34, true, kObjNone, kRelNone, -1, 1, 4, 100, 40, 5.0), PalColour(0x38, true, kObjMetal, kRelNone, -1, 1, 4, 70, 10), PalColour(0x3C, kRgbBlack), PalColour(0x41, kObjNone, kRelNone, -1, 1, 4, 100, 10, 10.0), PalColour(0x45, 0x41, 4, 90, 20, 10.0), PalColour(0x49, kObjNone, kRelAnalogous, 0x45, 1, 4, 100, 20, 20.0), PalColour(0x53, kRgbBlack), PalColour(0x54, kObjMetal, kRelNone, -1, 0.5f, 4, 80, 5), PalColour(0x58, kObjNatural, kRelNone, -1, 1, 2, 100, 70), PalColour(0x5A, kObjNatural, kRelNone, -1, 1, 2, 100, 70), PalColour(0x5C, 0x57, 50), PalColour(0x5D, 0x58, 120), PalColour(0x61, 0x41, 4, 120, 30, 10.0), PalColour(0x65, 0x45, 4, 110, 30, 10.0), PalColour(0x73, kRgbBlack), PalColour(0x74, 0x54, 4, 100, 25), PalColour(0x78, 0x58, 2, 100, 70), PalColour(0x7A, 0x5A, 2, 100, 70), PalColour(0x7C, 0x77, 50), PalColour(0x7D, 0x78, 120)};
+static constexpr PalColour kTemplate15[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x24, true, kObjNone, kRelNone, -1, 1, 4, 100, 30, 10.0), PalColour(0x28, true, kObjNone, kRelNone, -1, 1, 4, 50, 1), PalColour(0x34, true, kObjNone, kRelNone, -1, 1, 4, 100, 40, 5.0), PalColour(0x38, true, kObjMetal, kRelNone, -1, 1, 4, 70, 10), PalColour(0x3C, kRgbBlack), PalColour(0x41, kObjNone, kRelNone, -1, 1, 4, 100, 10, 10.0), PalColour(0x45, 0x41, 4, 90, 20, 10.0), PalColour(0x49, kObjNone, kRelAnalogous, 0x45, 1, 4, 100, 20, 20.0), PalColour(0x53, kRgbBlack), PalColour(0x54, kObjMetal, kRelNone, -1, 0.5f, 4, 80, 5), PalColour(0x58, kObjNatural, kRelNone, -1, 1, 2, 100, 70), PalColour(0x5A, kObjNatural, kRelNone, -1, 1, 2, 100, 70), PalColour(0x5C, 0x57, 50), PalColour(0x5D, 0x58, 120), PalColour(0x61, 0x41, 3, 100, 30, 10.0), PalColour(0x64, kObjGlass, kRelNone, -1, 1, 8, 100, 1, 10.0), PalColour(0x6C, 0x63, 50), PalColour(0x6D, 0x61, 120), PalColour(0x73, kRgbBlack), PalColour(0x74, 0x54, 4, 100, 25), PalColour(0x78, 0x58, 2, 100, 70), PalColour(0x7A, 0x5A, 2, 100, 70), PalColour(0x7C, 0x77, 50), PalColour(0x7D, 0x78, 120)};
+static constexpr PalColour kTemplate16[] = {PalColour(0x14, kObjMetal, kRelNone, -1, 0.4f, 4, 100, 5), PalColour(0x21, kObjNone, kRelNone, -1, 1, 4, 100, 5), PalColour(0x25, 0x21, 4, 90, 30), PalColour(0x29, kRgbWhite), PalColour(0x41, 0x21, 4, 80, 5), PalColour(0x45, 0x25, 4, 80, 20), PalColour(0x51, true, kObjNone, kRelCompliment, 0x21, 1, 4, 60, 5), PalColour(0x55, true, kObjNone, kRelNone, 0x51, 1, 4, 90, 30), PalColour(0x61, kObjNone, kRelNone, -1, 1, 4, 100, 5), PalColour(0x65, kObjNatural, kRelNone, -1, 1, 4, 100, 20), PalColour(0x69, kObjStone, kRelNone, -1, 1, 3, 100, 40), PalColour(0x6C, kObjNone, kRelCompliment, 0x61, 1, 3, 100, 40), PalColour(0x71, 0x21, 100), PalColour(0x72, kObjNone, kRelNone, -1, 1, 0, 100, -1), PalColour(0x73, 0x26, 100), PalColour(0x74, kObjNone, kRelAnalogous, 0x72, 1, 0, 100, -1), PalColour(0x75, kRgbWhite), PalColour(0x76, 0x45, 100), PalColour(0x77, 0x46, 100), PalColour(0x78, 0x25, 100)};
+static constexpr PalColour kTemplate18[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x24, kObjNone, kRelNone, -1, 1, 4, 100, 40, 10.0), PalColour(0x28, 0x24, 4, 80, 5), PalColour(0x2C, 0x2A, 70), PalColour(0x2D, 0x29, 120), PalColour(0x34, kObjNone, kRelCompliment, 0x24, 1, 7, 70, 30), PalColour(0x41, kObjMetal, kRelNone, -1, 1, 7, 100, 20), PalColour(0x48, kObjGlass, kRelNone, -1, 1, 4, 100, 30, 10.0), PalColour(0x51, kObjNatural, kRelNone, -1, 1, 3, 100, 30, 15.0), PalColour(0x54, kObjMetal, kRelNone, -1, 1, 4, 100, 5), PalColour(0x58, 0x54, 4, 120, 40), PalColour(0x61, kObjNatural, kRelNone, -1, 1, 8, 100, 20, 10.0), PalColour(0x69, kObjNatural, kRelNone, -1, 1, 3, 100, 30), PalColour(0x71, 0x61, 8, 100, 20, 10.0), PalColour(0x7C, kObjNatural, kRelNone, -1, 1, 4, 100, 5)};
+static constexpr PalColour kTemplate23[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x24, kObjNone, kRelNone, 0x24, 1, 4, 100, 20, 0, 6), PalColour(0x28, kObjNone, kRelNone, 0x28, 1, 4, 100, 5, 0, 6), PalColour(0x2C, kObjNone, kRelNone, 0x2C, 0, 100, -1, 0, 6), PalColour(0x34, 0x24, 4, 100, 5), PalColour(0x44, kObjNatural, kRelNone, -1, 1, 4, 100, 5, 10.0), PalColour(0x48, kRgbWhite), PalColour(0x49, 0x44, 3, 80, 5), PalColour(0x4C, 0x44, 130), PalColour(0x51, kObjNatural, kRelNone, -1, 1, 3, 100, 30, 15.0), PalColour(0x54, kObjNatural, kRelNone, -1, 1, 4, 100, 20, 10.0), PalColour(0x58, 0x54, 4, 60, 5), PalColour(0x71, kObjNatural, kRelNone, -1, 1, 3, 100, 30, 15.0), PalColour(0x74, kObjNatural, kRelNone, -1, 0.7f, 9, 100, 1, 10.0), PalColour(0x7D, kRgbLightGrey)};
+static constexpr PalColour kTemplate24[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x61, kRgbWhite), PalColour(0x62, kObjNone, kRelNone, -1, 1, 5, 100, 5, 10.0), PalColour(0x67, kObjNone, kRelNone, -1, 0.7, 5, 100, 10, 5.0), PalColour(0x6C, kObjNatural, kRelNone, -1, 1, 3, 100, 50, 10.0), PalColour(0x71, kRgbWhite), PalColour(0x72, kObjNone, kRelNone, -1, 1, 5, 100, 10), PalColour(0x77, 0x67, 5, 120, 20, 5.0), PalColour(0x7C, 0x6C, 3, 100, 50)};
+static constexpr PalColour kTemplate25[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjMetal, kRelNone, -1, 1, 4, 100, 20), PalColour(0x44, 0x41, 4, 120, 40), PalColour(0x51, kObjNatural, kRelNone, -1, 1, 4, 100, 5, 10.0), PalColour(0x55, 0x51, 4, 90, 40), PalColour(0x59, kObjNatural, kRelNone, -1, 1, 4, 100, 20), PalColour(0x5D, kObjNatural, kRelCompliment, 0x59, 1, 2, 100, 60), PalColour(0x61, kObjNone, kRelNone, -1, 1, 4, 100, 20, 10.0), PalColour(0x65, 0x61, 4, 90, 40), PalColour(0x69, kObjNatural, kRelNone, -1, 1, 4, 100, 5, 15.0), PalColour(0x6D, 0x6A, 90), PalColour(0x6E, 0x6A, 70), PalColour(0x71, kObjNone, kRelNone, -1, 1, 4, 100, 5, 10.0), PalColour(0x75, 0x71, 6, 90, 5), PalColour(0x7F, kObjNatural, kRelNone, -1, 1, 0, 100, -1)};
+
+// Vanilla specific ones
+static constexpr PalColour kTemplate1V[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjNone, kRelNone, -1, 0.8f, 3, 80, 30, 5.0), PalColour(0x44, kObjNone, kRelTriadic, 0x41, 0.9f, 4, 100, 1, 20.0), PalColour(0x48, kObjNone, kRelAnalogous, 0x44, 1, 4, 100, 5, 5.0), PalColour(0x4C, 0x41, 120), PalColour(0x51, kObjMetal, kRelNone, -1, 0.4f, 3, 100, 30), PalColour(0x54, kObjNone, kRelNone, -1, 0.5f, 5, 50, 20), PalColour(0x59, 0x58, 100), PalColour(0x5A, 0x59, 90), PalColour(0x5B, 0x5A, 90), PalColour(0x5C, kObjMetal, kRelNone, -1, 1, 2, 30, 20, 10.0), PalColour(0x4D, 0x53, 100), PalColour(0x24, kObjNone, kRelTriadic, 0x44, 0.9f, 4, 40, 1, 20.0), PalColour(0x64, kObjWater, kRelNone, -1, 1, 4, 70, 20, 10.0), PalColour(0x68, kObjNone, kRelCompliment, 0x48, 1, 4, 100, 5), PalColour(0x6C, kObjWater, kRelNone, -1, 1, 2, 100, 60), PalColour(0x74, kObjMetal, kRelNone, -1, 1, 4, 100, 30, 10.0), PalColour(0x78, 0x48, 4, 100, 5, 5.0)};
+static constexpr PalColour kTemplate2V[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjNone, kRelNone, -1, 0.8f, 3, 80, 30, 5.0), PalColour(0x44, kObjNone, kRelTriadic, 0x41, 0.9f, 4, 100, 1, 20.0), PalColour(0x48, kObjNone, kRelAnalogous, 0x44, 1, 4, 100, 5, 5.0), PalColour(0x4C, 0x41, 120), PalColour(0x51, kObjMetal, kRelNone, -1, 0.4f, 3, 100, 30), PalColour(0x54, kObjNone, kRelNone, -1, 0.5f, 5, 50, 20), PalColour(0x59, 0x58, 100), PalColour(0x5A, 0x59, 90), PalColour(0x5B, 0x5A, 90), PalColour(0x5C, kObjMetal, kRelNone, -1, 1, 2, 30, 20, 10.0), PalColour(0x4D, 0x53, 100), PalColour(0x24, kObjNone, kRelTriadic, 0x44, 0.9f, 4, 40, 1, 20.0), PalColour(0x64, kObjWater, kRelNone, -1, 1, 4, 70, 20, 10.0), PalColour(0x68, kObjNone, kRelCompliment, 0x48, 1, 4, 100, 5), PalColour(0x6C, kObjWater, kRelNone, -1, 1, 2, 100, 60), PalColour(0x74, kObjMetal, kRelNone, -1, 1, 4, 100, 30, 10.0), PalColour(0x78, 0x48, 4, 100, 5, 5.0)};
+static constexpr PalColour kTemplate3V[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjNone, kRelNone, -1, 1, 3, 80, 30), PalColour(0x44, kObjNone, kRelCompliment, 0x41, 0.5f, 4, 80, 1, 15.0), PalColour(0x48, kObjNatural, kRelNone, -1, 1, 2, 100, 70), PalColour(0x4B, kObjNone, kRelAnalogous, 0x48, 1, -2, 80, 30), PalColour(0x4C, 0x4A, 50), PalColour(0x4D, 0x4C, 50), PalColour(0x4E, 0x41, 110), PalColour(0x51, kObjMetal, kRelNone, -1, 0.5f, 3, 80, 30), PalColour(0x54, 0x44, 4, 80, 5), PalColour(0x58, kObjNatural, kRelNone, -1, 1, 2, 100, 80), PalColour(0x5A, 0x4A, 2, 100, 40), PalColour(0x5C, 0x53, 30), PalColour(0x5D, 0x58, 120), PalColour(0x5E, 0x51, 120), PalColour(0x61, kObjNone, kRelNone, -1, 1, 3, 80, 30), PalColour(0x64, 0x54, 4, 100, 30), PalColour(0x68, kObjMetal, kRelNone, -1, 1, 4, 100, 5), PalColour(0x71, 0x51, 3, 80, 20), PalColour(0x74, 0x54, 3, 120, 80), PalColour(0x78, kObjMetal, kRelNone, -1, 1, 4, 100, 20)};
+static constexpr PalColour kTemplate4V[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x41, kObjNone, kRelNone, -1, 0.7f, 3, 80, 30), PalColour(0x44, kObjNone, kRelCompliment, 0x41, 0.7f, 4, 80, 20, 10.0), PalColour(0x48, kObjNatural, kRelNone, -1, 1, 2, 100, 70), PalColour(0x4A, kObjNone, kRelAnalogous, 0x48, 1, 2, 70, 40), PalColour(0x4E, 0x41, 110), PalColour(0x51, 0x41, 3, 60, 5), PalColour(0x54, kObjMetal, kRelNone, -1, 1, 4, 40, 5, 10.0), PalColour(0x58, kObjNatural, kRelNone, -1, 1, 2, 100, 80), PalColour(0x5A, 0x4A, 2, 100, 20), PalColour(0x5C, 0x53, 30), PalColour(0x5D, 0x58, 120), PalColour(0x5E, 0x51, 120), PalColour(0x61, kObjMetal, kRelNone, -1, 0.7f, 3, 80, 30), PalColour(0x64, 0x54, 4, 100, 30), PalColour(0x68, kObjMetal, kRelNone, -1, 1, 4, 100, 5), PalColour(0x71, 0x51, 3, 80, 20), PalColour(0x74, 0x54, 3, 120, 80), PalColour(0x78, kObjMetal, kRelNone, -1, 1, 4, 100, 20), PalColour(0x7E, 0x71, 120)};
+static constexpr PalColour kTemplate7V[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x28, kObjNatural, kRelNone, -1, 1, 4, 50, 5), PalColour(0x2C, Rgb(227,194,212)), PalColour(0x31, kObjNatural, kRelNone, -1, 1, 7, 100, 5, 10.0), PalColour(0x48, kObjNatural, kRelNone, -1, 0.8f, 3, 100, 60), PalColour(0x44, kObjNone, kRelNone, 0x49, 1, 4, 80, 10, 10.0), PalColour(0x43, 0x46, 80), PalColour(0x4C, 0x48, 100), PalColour(0x4E, 0x4C, 110), PalColour(0x51, kObjNatural, kRelNone, -1, 1, 3, 100, 40, 15.0), PalColour(0x54, kObjNone, kRelNone, 0x4C, 0.7f, 4, 100, 60, 10.0), PalColour(0x58, kObjNone, kRelAnalogous, 0x54, 1, 4, 40, 1), PalColour(0x24, 0x54, 4, 100, 20), PalColour(0x61, kObjNatural, kRelNone, -1, 0.6f, 7, 90, 1, 7.5), PalColour(0x68, kObjNone, kRelCompliment, 0x61, 1, 4, 100, 5), PalColour(0x71, kObjNone, kRelCompliment, 0x61, 1, 3, 100, 5), PalColour(0x74, kObjNone, kRelNone, -1, 0.7f, 4, 60, 5)};
+static constexpr PalColour kTemplate12V[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x24, kObjStone, kRelNone, -1, 0.6f, 4, 100, 30, 5.0), PalColour(0x24, kObjNone, kRelNone, -1, 0.6f, 4, 60, 5, 5.0), PalColour(0x2C, 0x04, 100), PalColour(0x2D, 0x05, 100), PalColour(0x34, kObjNatural, kRelNone, -1, 0.7f, 4, 60, 5, 5.0), PalColour(0x38, kObjNone, kRelAnalogous, 0x34, 1, 4, 100, 20, 5.0), PalColour(0x3C, 0x38, 130), PalColour(0x3E, 0x3C, 150), PalColour(0x41, kObjNone, kRelNone, -1, 0.8f, 3, 70, 30, 5.0), PalColour(0x44, 0x28, 4, 100, 30), PalColour(0x48, kObjNone, kRelTriadic, 0x41, 1, 4, 140, 20, 15.0), PalColour(0x4D, 0x41, 150), PalColour(0x51, kObjNone, kRelNone, -1, 1, 3, 100, 20), PalColour(0x54, kObjNone, kRelTriadic, 0x48, 1, 4, 100, 5, 5.0), PalColour(0x5B, kObjNone, kRelCompliment, 0x54, 1, -4, 100, 10, 10.0), PalColour(0x5D, 0x58, 50), PalColour(0x68, 0x58, 4, 100, 5), PalColour(0x6C, 0x69, 100), PalColour(0x74, 0x54, 4, 100, 20), PalColour(0x78, kObjGlass, kRelNone, -1, 1, 6, 100, 20, 10.0), PalColour(0x7E, 0x77, 60)};
+static constexpr PalColour kTemplate13V[] = {PalColour(0x04, kObjNone, kRelNone, -1, 0.4f, 4, 80, 5, 10.0), PalColour(0x24, kObjStone, kRelNone, -1, 0.6f, 8, 100, 30, 5.0), PalColour(0x2C, 0x04, 100), PalColour(0x2D, 0x05, 100), PalColour(0x3B, kObjNatural, kRelNone, -1, 0.7f, -8, 100, 5, 5.0), PalColour(0x3C, 0x38, 130), PalColour(0x3E, 0x3C, 150), PalColour(0x41, kObjNone, kRelNone, -1, 0.8f, 3, 70, 30, 5.0), PalColour(0x44, 0x28, 4, 100, 30), PalColour(0x48, kObjNone, kRelTriadic, 0x41, 1, 4, 140, 20, 15.0), PalColour(0x4D, 0x41, 150), PalColour(0x51, kObjNone, kRelNone, -1, 1, 3, 100, 20), PalColour(0x54, kObjNone, kRelTriadic, 0x48, 1, 4, 100, 5, 5.0), PalColour(0x5B, kObjNone, kRelCompliment, 0x54, 1, -4, 100, 10, 10.0), PalColour(0x5D, 0x58, 50), PalColour(0x6B, 0x58, -8, 100, 5), PalColour(0x6C, 0x69, 100), PalColour(0x74, kObjNone, kRelNone, -1, 1, 4, 100, 20), PalColour(0x78, kObjGlass, kRelNone, -1, 1, 6, 100, 20, 10.0), PalColour(0x7E, 0x77, 60)};
+
+// Which template each tileset uses (17-20 share the palettes of 15 and 16, so theirs are never used)
+static constexpr TilesetTemplate kTilesetTemplates[29] = {tilesetTemplate(kTemplate1), tilesetTemplate(kTemplate2), tilesetTemplate(kTemplate3), tilesetTemplate(kTemplate4), tilesetTemplate(kTemplate5), tilesetTemplate(kTemplate6), tilesetTemplate(kTemplate7), tilesetTemplate(kTemplate8), tilesetTemplate(kTemplate8), tilesetTemplate(kTemplate10), tilesetTemplate(kTemplate11), tilesetTemplate(kTemplate12), tilesetTemplate(kTemplate13), tilesetTemplate(kTemplate14), tilesetTemplate(kTemplate15), tilesetTemplate(kTemplate16), tilesetTemplate(kTemplate16), tilesetTemplate(kTemplate1), tilesetTemplate(kTemplate1), tilesetTemplate(kTemplate1), tilesetTemplate(kTemplate1), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate23), tilesetTemplate(kTemplate24), tilesetTemplate(kTemplate25)};
+static constexpr TilesetTemplate kTilesetTemplatesVanilla[29] = {tilesetTemplate(kTemplate1V), tilesetTemplate(kTemplate2V), tilesetTemplate(kTemplate3V), tilesetTemplate(kTemplate4V), tilesetTemplate(kTemplate5), tilesetTemplate(kTemplate6), tilesetTemplate(kTemplate7V), tilesetTemplate(kTemplate8), tilesetTemplate(kTemplate8), tilesetTemplate(kTemplate10), tilesetTemplate(kTemplate11), tilesetTemplate(kTemplate12V), tilesetTemplate(kTemplate13V), tilesetTemplate(kTemplate14), tilesetTemplate(kTemplate15), tilesetTemplate(kTemplate16), tilesetTemplate(kTemplate16), tilesetTemplate(kTemplate1), tilesetTemplate(kTemplate1), tilesetTemplate(kTemplate1), tilesetTemplate(kTemplate1), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate18), tilesetTemplate(kTemplate23), tilesetTemplate(kTemplate24), tilesetTemplate(kTemplate25)};
+
+// Tilesets 17-20 don't get their own palette, they just share the ones from 15 and 16
+static const int kPaletteSource[29] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 15, 16, 15, 16, 21, 22, 23, 24, 25, 26, 27, 28};
+
+void Generator::makeNewTilesetPalettes() {
+	TRACE_SCOPE("makeNewTilesetPalettes");
+
+	// Now we set up the tileset palettes themselves
+	Palette128 p[25];
+
+	Rgb *tilesets[29] = {p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8], p[9], p[10], p[11], p[12], p[13], p[14], p[15], p[16], nullptr, nullptr, nullptr, nullptr, p[17], p[18], p[19], p[20], p[21], p[22], p[23], p[24]};
+
+	makeTilesetPalettes(tilesets, _settings, stream(kStreamTilesets));
+
+	// Then we compress these new palettes into free space in the rom (all at once, so shared palettes are only compressed once)
+	uint64_t offsets[29];
+	int failed = _rom->compressPalettes(tilesets, offsets, 29, &_cancel);
+	if (cancelled() == true) {
+		return;
+	}
+
+	// The free space includes where the original palettes are, so one that didn't fit would be left pointing at whatever got written over it.
+	// So either every tileset gets its new palette, or none of them do and the original palettes get put back
+	if (failed > 0) {
+		TRACE_LOG(kLogError, "ran out of space for the tileset palettes, so they were left as they were");
+		_log += "Tileset palettes: not enough free space, so they were left as they were\n\n";
+		_rom->revertFreeSpace(_settings.vanilla);
+		return;
+	}
+
+	// Even in PB the original palette locations are a little small, so we repoint all of them to wherever they ended up
+	for (int i = 0; i < 29; i++) {
+		_rom->setLong(kAddrGfxPal + (i * 9), Rom::pcToSnes(offsets[kPaletteSource[i]]));
+	}
+
+	// Only now that the new palettes are definitely in do we fix the heat palettes to reflect the new norfair colours
+	fixHeatPalettes(tilesets);
+
+	// Also the glows
+	fixGlowPalettes(tilesets);
+
+	// Keep a copy of them all for the window to show once the seed is done
+	for (int i = 0; i < 29; i++) {
+		std::copy(tilesets[kPaletteSource[i]], tilesets[kPaletteSource[i]] + kPaletteColours, _generatedPalettes[i]);
+	}
+
+	// The initial haze colour is now decided by the palette colour
+	if (_settings.vanilla == true) {
+		wxByte num = 0;
+
+		// Get the main colour for ceres tiles
+		Rgb clr = tilesets[14][0x25];
+
+		// Then depending on the intensity of each colour, set the colour bit of the haze byte
+		if (clr.r > 128) {
+			num |= 0x80;
+		}
+		if (clr.g > 128) {
+			num |= 0x40;
+		}
+		if (clr.b > 128) {
+			num |= 0x20;
+		}
+		_rom->setByte(0x45E11, num);
+	}
+}
+
+// Makes every tileset palette without touching the rom, so the preview can use it too
+void Generator::makeTilesetPalettes(Rgb *tilesets[29], const RandoSettings &settings, const Rng &paletteRng) {
+	TRACE_SCOPE("makeTilesetPalettes");
+
+	// If the rom is vanilla, we want to use slightly different templates for the tilesets
+	const TilesetTemplate *templates = (settings.vanilla == true) ? kTilesetTemplatesVanilla : kTilesetTemplates;
+	const PaletteOptions &options = settings.palette;
+
+	/* Most tilesets don't depend on any other, but with continuity on, some take colours from another tileset, which
+	 * has to be finished first. So each tileset goes in a wave one after the last of the tilesets it takes colours from,
+	 * and everything in a wave gets made at the same time.
+	 */
+	int wave[29] = {0};
+	bool changed = true;
+	for (int pass = 0; (pass < 29) && (changed == true) && (options.continuity == true); pass++) {
+		changed = false;
+		for (int t = 0; t < 29; t++) {
+			if (tilesets[t] == nullptr) {
+				continue;
+			}
+
+			for (int i = 0; i < templates[t].size; i++) {
+				int other = templates[t].colours[i].tileset;
+				if ((other >= 0) && (other != t) && (tilesets[other] != nullptr) && (wave[t] <= wave[other])) {
+					wave[t] = wave[other] + 1;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	int numWaves = 1;
+	for (int t = 0; t < 29; t++) {
+		numWaves = std::max(numWaves, wave[t] + 1);
+	}
+
+	// Now the actual palette creation algorithm
+	for (int w = 0; w < numWaves; w++) {
+		std::vector<int> batch;
+		for (int t = 0; t < 29; t++) {
+			if ((tilesets[t] != nullptr) && (wave[t] == w)) {
+				batch.push_back(t);
+			}
+		}
+
+		parallelFor(batch.size(), [&](size_t b) {
+			int t = batch[b];
+
+			// Start by blacking out the entire tileset
+			for (int i = 0; i < kPaletteColours; i++) {
+				// Except for the 0x0E colour for each line after the first two, which is usually white
+				if (((i % 16) == 0x0E) && (i > 0x20)) {
+					tilesets[t][i] = kRgbWhite;
+		
+				} else {
+					tilesets[t][i] = kRgbBlack;
+				}
+			}
+
+			// Each tileset gets its own random numbers, so it doesn't matter what order (or which thread) they're made in
+			Rng rng = paletteRng.derive(t);
+			processTilesetTemplate(tilesets, templates, t, options, rng);
+		});
+	}
+
+	// Now we input the colours that stay the same in every tileset
+	writeLockedPaletteColours(tilesets, settings);
+}
+
+// The same palettes as a seed, but just handed back (17-20 included) instead of going into the rom
+void Generator::tilesetPalettes(const RandoSettings &settings, const Rng &paletteRng, Palette128 palettes[kNumTilesets]) {
+	Palette128 p[25];
+	Rgb *tilesets[29] = {p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8], p[9], p[10], p[11], p[12], p[13], p[14], p[15], p[16], nullptr, nullptr, nullptr, nullptr, p[17], p[18], p[19], p[20], p[21], p[22], p[23], p[24]};
+	makeTilesetPalettes(tilesets, settings, paletteRng);
+
+	for (int i = 0; i < 29; i++) {
+		std::copy(tilesets[kPaletteSource[i]], tilesets[kPaletteSource[i]] + kPaletteColours, palettes[i]);
+	}
+}
+
+/* The glow and heat tables
+ * Brinstar and norfair go through their frames and then back again, but in the
+ * brinstar glows the way back starts from the top, so frames 5 and 6 end up darker
+ * than the ones either side of them. That's how the game has always looked, so it
+ * stays that way.
+ */
+static const GlowCurve kGlowWreckedShip = {8, {100, 90, 80, 70, 60, 70, 80, 90}, {1, 1, 1, 1, 1, 1, 1, 1}};
+static const GlowCurve kGlowRedBrinstar = {14, {85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85}, {0, 1, 2, 3, 4, 8, 7, 6, 5, 4, 3, 2, 1, 0}};
+static const GlowCurve kGlowGreenBrinstar = {14, {90, 90, 90, 90, 90, 90, 90, 90, 90, 90, 90, 90, 90, 90}, {0, 1, 2, 3, 4, 8, 7, 6, 5, 4, 3, 2, 1, 0}};
+static const GlowCurve kGlowHeat = {16, {110, 110, 110, 110, 110, 110, 110, 110, 110, 110, 110, 110, 110, 110, 110, 110}, {0, 1, 2, 3, 4, 5, 6, 7, 7, 6, 5, 4, 3, 2, 1, 0}};
+
+static const GlowRow kGlowRows[] = {
+	{0x6EAE8, 0x08, 4, 0x4C, 2, &kGlowWreckedShip},		// Wrecked ship green glow
+	{0x6EEDD, 0x14, 7, 0x64, 8, &kGlowRedBrinstar},		// Red brinstar purple glow
+	{0x6ED9F, 0x0A, 6, 0x71, 3, &kGlowGreenBrinstar}		// Green brinstar glow
+};
+
+static const GlowRow kHeatRows[] = {
+	{0x6F1D7, 0x10, 9, 0x41, 3, &kGlowHeat},			// Main heat
+	{0x6F1DF, 0x10, 9, 0x4C, 2, &kGlowHeat},			// Bubbles and tiles
+	{0x6F097, 0x13, 9, 0x41, 3, &kGlowHeat},			// Pipes
+	{0x6F09F, 0x13, 9, 0x4C, 2, &kGlowHeat},			// Blocks
+	{0x6F2DF, 0x10, 9, 0x41, 3, &kGlowHeat},			// Other heat
+	{0x6F2E7, 0x10, 9, 0x5C, 2, &kGlowHeat},			// Stone and rock
+	{0x6F3E7, 0x10, 9, 0x61, 3, &kGlowHeat},			// Dark heat
+	{0x6F3EF, 0x10, 9, 0x6C, 2, &kGlowHeat}			// Dark stone and rock
+};
+
+void Generator::fixGlowPalettes(Rgb *tilesets[29]) {
+	writeGlowPalettes(tilesets, kGlowRows, sizeof(kGlowRows) / sizeof(GlowRow));
+}
+
+void Generator::fixHeatPalettes(Rgb *tilesets[29]) {
+	writeGlowPalettes(tilesets, kHeatRows, sizeof(kHeatRows) / sizeof(GlowRow));
+}
+
+void Generator::writeGlowPalettes(Rgb *tilesets[29], const GlowRow *rows, int count) {
+	TRACE_SCOPE("writeGlowPalettes");
+
+	wxByte frame[kGlowMaxColours * 2];
+
+	for (int r = 0; r < count; r++) {
+		const GlowRow &row = rows[r];
+		const GlowCurve &curve = *row.curve;
+
+		// Each frame is worked out from the tileset colours, and then the whole frame is written at once
+		for (int f = 0; f < curve.frames; f++) {
+			for (int c = 0; c < row.count; c++) {
+				Rgb clr = tilesets[row.tileset][row.index + c];
+				for (int t = 0; t < curve.times[f]; t++) {
+					clr = changeLightness(clr, curve.amount[f]);
+				}
+
+				uint16_t colour = colourTo15(clr);
+				frame[c * 2] = colour & 0xFF;
+				frame[(c * 2) + 1] = colour >> 8;
+			}
+			_rom->setBytes(row.addr + (f * row.stride), frame, row.count * 2);
+		}
+	}
+}
+
+void Generator::processTilesetTemplate(Rgb *tilesets[29], const TilesetTemplate templates[29], int t, const PaletteOptions &options, Rng &rng) {
+	TRACE_SCOPE("processTilesetTemplate");
+
+	// Now we need to define the material colours
+	// Natural objects get the widest range of possible starting colours
+	Rgb objNatural[16] = {Rgb(148,55,255), Rgb(255,38,0), Rgb(4,51,255), Rgb(255,251,0),
+						  Rgb(255,147,0), Rgb(0,250,146), Rgb(142,250,0), Rgb(255,47,146),
+						  Rgb(0,150,255), Rgb(122,129,255), Rgb(215,131,255), Rgb(255,138,216),
+						  Rgb(255,252,121), Rgb(148,17,0), Rgb(255,126,121), Rgb(115,250,121)};
+
+	// Metal objects get silvers, browns, reds
+	Rgb objMetal[16] = {Rgb(189,192,197), Rgb(138,93,78), Rgb(172,173,180), Rgb(175,119,43),
+						Rgb(192,192,192), Rgb(121,121,121), Rgb(169,169,169), Rgb(235,235,235),
+						Rgb(140,140,140), Rgb(184,122,74), Rgb(117,106,96), Rgb(149,137,120),
+						Rgb(75,77,74), Rgb(111,98,80), Rgb(119,103,92), Rgb(112,73,51)};
+
+	// Stone objects are greys and browns mostly
+	Rgb objStone[24] = {Rgb(169,169,169), Rgb(94,94,94), Rgb(180,91,7), Rgb(148,82,0),
+						Rgb(83,27,147), Rgb(148,23,81), Rgb(255,147,0), Rgb(146,144,0),
+						Rgb(155,148,140), Rgb(86,59,36), Rgb(101,58,41), Rgb(212,209,204),
+						Rgb(181,150,128), Rgb(81,83,82), Rgb(80,65,67), Rgb(97,95,71),
+						Rgb(174,175,174), Rgb(159,162,161), Rgb(163,161,162), Rgb(147,151,155),
+						Rgb(110,87,84), Rgb(85,70,70), Rgb(145,145,138), Rgb(70,78,87)};
+
+	// Glass/Ice objects get light colours like blue, white, yellow, etc.
+	Rgb objGlass[6] = {Rgb(115,253,255), Rgb(115,252,214), Rgb(212,251,121), Rgb(255,255,255), Rgb(255,252,121), Rgb(255,126,121)};
+
+	// Water get various kinds of blues
+	Rgb objWater[8] = {Rgb(90,158,179), Rgb(99,161,188), Rgb(72,128,150), Rgb(160,232,222),
+					   Rgb(21,38,58),  Rgb(49,99,162), Rgb(56,115,167), Rgb(48,95,137)};
+
+	// The random colours are kept at least 0.1 apart in hue
+	HueAllocator hues(kFixedOne / 10);
+
+	// For use at various points
+	FixedHSV hsv;
+
+	for (int i = 0; i < templates[t].size; i++) {
+		// The template itself is shared and never changes, so anything we change for this seed goes in our own copy
+		PalColour pal = templates[t].colours[i];
+
+		// Silhouette mode just colours in the background for a given tileset, not the foreground
+		if ((options.silhouette == true) && pal.background == false) {
+			continue;
+		}
+
+		// If continuity is set to off, then we want to make sure to remove the reference from any colours that have continuity
+		if ((pal.tileset != -1) && (options.continuity == false)) {
+			pal.reference = -1;
+			pal.tileset = -1;
+		}
+
+		// First thing we need is a colour, which will be used and possibly changed
+		Rgb clr;
+
+		// If the object has a hard coded colour, we want to use that one
+		if (pal.hardCoded == true) {
+			clr = pal.colour;
+
+		} else if (pal.relation != kRelNone) {
+			// First we grab the reference colour
+			clr = tilesets[t][pal.reference];
+
+			// Then we convert it into OkHSV so we can change the hue
+			hsv = okhsvFrom15(colourTo15(clr));
+
+			// Then we apply the transformation
+			switch (pal.relation) {
+				case kRelCompliment:
+					// Complimentary colours are opposite from each other on the colour wheel
+					hsv.h = wrapHue(hsv.h + hueDegrees(180));
+					break;
+				case kRelAnalogous:
+					// Analogous colours are roughly 40 - 60 degrees apart
+					hsv.h = wrapHue(hsv.h + hueDegrees(50));
+					break;
+				case kRelTriadic:
+					// Triadic colours are 120 degrees apart (a triangle)
+					hsv.h = wrapHue(hsv.h + hueDegrees(120));
+					break;
+				case kRelTetradic:
+					// Tetradic colours are 90 degrees apart (a square)
+					hsv.h = wrapHue(hsv.h + hueDegrees(90));
+				default:
+					break;
+			}
+			clr = rgbFrom15(okhsvTo15(hsv));
+
+		// If the object is referencing another colour, we want to use that one
+		} else if (pal.reference != -1) {
+			// If the colour references another tileset, use the number as the tileset to reference
+			if (pal.tileset != -1) {
+				// And we want to change the brightness to whatever the object defines
+				clr = changeLightness(tilesets[pal.tileset][pal.reference], pal.brightnessS);
+			
+			} else {
+				clr = changeLightness(tilesets[t][pal.reference], pal.brightnessS);	
+			}
+
+		// If the object has a material type, we want to pick from material colour pools
+		} else if (pal.object != kObjNone) {
+			switch (pal.object) {
+				case kObjNatural:
+					clr = objNatural[rng.below(16)];
+					break;
+				case kObjMetal:
+					clr = objMetal[rng.below(16)];
+					break;
+				case kObjStone:
+					clr = objStone[rng.below(24)];
+					break;
+				case kObjGlass:
+					clr = objGlass[rng.below(6)];
+					break;
+				case kObjWater:
+					clr = objWater[rng.below(8)];
+				default:
+					break;
+			}
+
+		// otherwise it's just a completely random colour
+		} else {
+			uint8_t red = rng.below(255);
+			uint8_t green = rng.below(255);
+			uint8_t blue = rng.below(255);
+			clr = Rgb(red, green, blue);
+			// And we want to make sure the colour is bright enough to start
+			if (luminance(clr) < kLuminanceHalf) {
+				clr = changeLightness(clr, 150);
+			}
+
+			// That being said, we want to make sure the colour is not really close to another colour we've already chosen, so the hue comes from whatever is still free
+			hsv = okhsvFrom15(colourTo15(clr));
+			hsv.h = hues.take(rng.next() >> (64 - kFixedShift));
+			clr = rgbFrom15(okhsvTo15(hsv));
+		}
+
+		// If the saturation level is less than 1, we convert to OkHSV and change the saturation
+		if (pal.saturation != 1) {
+			hsv = okhsvFrom15(colourTo15(clr));
+
+			hsv.s = toFixed(pal.saturation);
+
+			clr = rgbFrom15(okhsvTo15(hsv));
+		}
+
+
+		// If the object has a gradient, create one
+		if (pal.gradient != 0) {
+			// Difference is the total difference in luminance between start and end
+			int diff = pal.brightnessS - pal.brightnessE;
+
+			// Step is the amount of change per step
+			int step = diff / std::abs(pal.gradient);
+			int numSteps = std::abs(pal.gradient);
+
+			// Index is the starting position of the gradient
+			int index = pal.index;
+
+			hsv = okhsvFrom15(colourTo15(clr));
+
+			// We have the brightness step from the template, but we need the percentage of the colours actual brightness to use for stepping in the gradient
+			Fixed percent = (hsv.v * step) / 100;
+			hsv.v = (hsv.v * pal.brightnessS) / 100;
+
+			// Every step of the gradient is worked out first, so they can all be converted in one go
+			std::vector<FixedHSV> steps(numSteps);
+			std::vector<uint16_t> colours(numSteps);
+			for (int s = 0; s < numSteps; s++) {
+				steps[s] = hsv;
+				hsv.v -= percent;
+				if (pal.hueShift != 0) {
+					hsv.h = wrapHue(hsv.h + hueDegrees(pal.hueShift));
+				}
+			}
+			okhsvTo15(steps.data(), colours.data(), numSteps);
+
+			for (int s = 0; s < numSteps; s++) {
+				clr = rgbFrom15(colours[s]);
+
+				// Now if we want greyscale, we just use makeGrey() on whatever colour we have
+				if (options.greyscale == true) {
+					tilesets[t][index] = makeGrey(clr);
+
+				} else {
+					tilesets[t][index] = clr;						
+				}
+
+				// If the gradient is negative, it goes backwards
+				if (pal.gradient < 0) {
+					index--;
+				} else {
+					index++;
+				}
+			}
+		
+		} else {
+			if (options.greyscale == true) {
+				tilesets[t][pal.index] = makeGrey(clr);
+
+			} else {
+				tilesets[t][pal.index] = clr;					
+			}
+		}
+	}
+}
+
+void Generator::writeLockedPaletteColours(Rgb *tilesets[29], const RandoSettings &settings) {
+	TRACE_SCOPE("writeLockedPaletteColours");
+
+	// First we need to define the colours that don't get randomized, like the doors
+	Rgb doorsP[3] = {Rgb(0xf8,0xc0,0x01), Rgb(0xd0,0x78,0x01), Rgb(0x80,0x20,0x01)};
+	Rgb doorsS[3] = {Rgb(0x90,0xf8,0x20), Rgb(0x40,0xa8,0x20), Rgb(0x18,0x48,0x10)};
+	Rgb doorsM[3] = {Rgb(0xe0,0xa8,0xe0), Rgb(0xd8,0x38,0x90), Rgb(0xb0,0x01,0x30)};
+	Rgb doorsB[3] = {Rgb(0x90,0xa8,0xe0), Rgb(0x38,0x70,0xe0), Rgb(0x18,0x40,0x98)};
+
+	// And the hud/door tubes
+	Rgb hud[4] = {Rgb(0xd8,0xa8,0xb8), Rgb(0x98,0x68,0x78), Rgb(0x70,0x48,0x50), Rgb(0x30,0x20,0x28)};
+
+	// The misc used in items and sprites
+	Rgb misc[5] = {Rgb(0x88,0xe8,0x10), Rgb(0xd8,0x38,0x90), Rgb(0xf8,0xf8,0xf8), Rgb(0x1,0x1,0x1), Rgb(0xf8,0xf8,0xf8)};
+
+	// And the ones that I forget the purpose of
+	Rgb other[7] = {Rgb(0xc0,0xc0,0xc0), Rgb(0x38,0x38,0x38), Rgb(0x20,0x20,0x20), Rgb(0x1,0x1,0x1), Rgb(0xf8,0xf8,0xf8), Rgb(0xf8,0xb0,0x1), Rgb(0xf8,0x1,0x1)};
+
+	// And the two hud colours the user picked
+	Rgb hud1 = settings.hud1;
+	Rgb hud2 = settings.hud2;
+
+	// Fill out the predefined colours
+	for (int i = 0; i < 29; i++) {
+		if (tilesets[i] != nullptr) {
+			for (int j = 0; j < 3; j++) {
+				tilesets[i][0x1 + j] = doorsP[j];
+			}
+
+			for (int j = 0; j < 3; j++) {
+				tilesets[i][0x11 + j] = doorsS[j];
+			}
+
+			for (int j = 0; j < 4; j++) {
+				tilesets[i][0x14 + j] = hud[j];
+			}
+
+			for (int j = 0; j < 5; j++) {
+				tilesets[i][0x8 + j] = misc[j];
+			}
+
+			for (int j = 0; j < 7; j++) {
+				tilesets[i][0x18 + j] = other[j];
+			}
+
+			// In the ceres tilset, lines 0x2 and 0x3 are used for the tileset
+			if ((i < 15) || (i > 20)) {
+				for (int j = 0; j < 3; j++) {
+					tilesets[i][0x21 + j] = doorsM[j];
+				}
+
+				for (int j = 0; j < 3; j++) {
+					tilesets[i][0x31 + j] = doorsB[j];
+				}
+			}
+			
+			tilesets[i][0x0D] = hud2;
+			tilesets[i][0x0E] = hud1;
+		}
+	}
+
+}
+
+void Generator::shuffleBeamPalettes() {
+	TRACE_SCOPE("shuffleBeamPalettes");
+
+	wxVector<wxVector<int>> palettes;
+	for (int i = 0; i < 12; i++) {
+		wxVector<int> palette;
+		palette.push_back(_rom->getByte(kAddrBeamPal + (i * 2)));
+		palette.push_back(_rom->getByte(kAddrBeamPal + (i * 2)+ 1));
+		// This should also do beam_type and beam_type_charge in bank 91
+		palettes.push_back(palette);
+	}
+
+	Rng rng = stream(kStreamBeams);
+	rng.shuffle(palettes.begin(), palettes.end());
+	for (int i = 0; i < 12; i++) {
+		_rom->setByte(kAddrBeamPal + (i * 2), palettes[i][0]);
+		_rom->setByte(kAddrBeamPal + (i * 2) + 1, palettes[i][1]);
+	}
+}
+
+void Generator::shuffleSuitPalettes() {
+	TRACE_SCOPE("shuffleSuitPalettes");
+
+	wxVector<wxByte **> palettes;
+
+	// Selected by default, we include the vanilla palettes
+	if (_settings.includeVanilla == true) {
+		palettes.push_back(_palettePower);
+		palettes.push_back(_paletteVaria);
+		palettes.push_back(_paletteGravity);
+	}
+
+	// But if expanded is checked, we include the PB expanded suit palettes
+	if (_settings.includePBExpanded == true) {
+		palettes.push_back(_paletteSlate);
+		palettes.push_back(_palettePhazon);
+		palettes.push_back(_paletteWhite);
+		palettes.push_back(_paletteGrime);
+		palettes.push_back(_paletteGreen);
+		palettes.push_back(_paletteFusion);
+	}
+
+	// And if hacks is checked, we also include the hack palettes
+	if (_settings.includeHacks == true) {
+		palettes.push_back(_palettePhazonP);
+		palettes.push_back(_palettePhazonV);
+		palettes.push_back(_palettePhazonG);
+		palettes.push_back(_paletteHallowEve);
+		palettes.push_back(_paletteFinalStandP);
+		palettes.push_back(_paletteFinalStandV);
+		palettes.push_back(_paletteFinalStandG);
+		palettes.push_back(_paletteLostWorldP);
+		palettes.push_back(_paletteLostWorldG);
+		palettes.push_back(_paletteVanillaPlus);
+		palettes.push_back(_paletteHyperP);
+		palettes.push_back(_paletteHyperV);
+		palettes.push_back(_paletteHyperG);
+		palettes.push_back(_paletteIceMetalP);
+		palettes.push_back(_paletteIceMetalV);
+		palettes.push_back(_paletteIceMetalG);
+	}
+
+	// If nothing is selected but shuffle is still applied, just do nothing
+	if (palettes.size() == 0) {
+		return;
+	}
+
+	// Otherwise, we choose a random suit for each one (power, varia, gravity)
+	int *addresses[3] = {_paletteAddrPower, _paletteAddrVaria, _paletteAddrGravity};
+	wxVector<wxByte **> included = palettes;
+	wxByte **chosen[3];
+	Rng rng = stream(kStreamSuits);
+	for (int s = 0; s < 3; s++) {
+		int pal = rng.below(palettes.size());
+		chosen[s] = palettes[pal];
+		palettes.erase(palettes.begin() + pal);
+	}
+
+	if (_settings.generateSuitPal == true) {
+		generateSuitPalettes(chosen, included);
+		return;
+	}
+
+	for (int s = 0; s < 3; s++) {
+		for (int i = 0; i < 8; i++) {
+			_rom->setBytes(addresses[s][i], chosen[s][i], _paletteSizes[i]);
+		}
+	}
+}
+
+/* Instead of using the suits as they are, this makes new ones out of them. Each suit
+ * keeps the lightness of every colour from the suit it started as, so the shading
+ * is the same, but its colour is blended towards another one of the included suits
+ * and then its hue is turned. Every line of all three suits goes through the colour
+ * maths together.
+ */
+void Generator::generateSuitPalettes(wxByte **chosen[3], const wxVector<wxByte **> &included) {
+	TRACE_SCOPE("generateSuitPalettes");
+
+	int *addresses[3] = {_paletteAddrPower, _paletteAddrVaria, _paletteAddrGravity};
+
+	// Colour 0 of each line is transparent, so that one is left alone
+	const int size = 15;
+	std::vector<uint16_t> colours;
+	std::vector<uint16_t> blend;
+	std::vector<Fixed> amounts;
+	std::vector<PaletteShift> shifts;
+
+	// The new suits get their own stream, so turning this on doesn't change which suits get picked
+	Rng rng = stream(kStreamSuits).derive(1);
+	for (int s = 0; s < 3; s++) {
+		// Only the suits that were included can be blended in, so unchecking a group keeps its colours out entirely
+		wxByte **other = included[rng.below(included.size())];
+		Fixed amount = rng.next() >> (64 - kFixedShift);
+		PaletteShift shift = {(Fixed) (rng.next() >> (64 - kFixedShift)), ((kFixedOne * 3) / 4) + (Fixed) (rng.next() >> (64 - kFixedShift + 1))};
+
+		for (int i = 0; i < 8; i++) {
+			for (int line = 0; line < _paletteSizes[i]; line += _paletteStrides[i]) {
+				for (int j = 1; j <= size; j++) {
+					int k = line + (j * 2);
+					colours.push_back(chosen[s][i][k] | (chosen[s][i][k + 1] << 8));
+					blend.push_back(other[i][k] | (other[i][k + 1] << 8));
+				}
+				amounts.push_back(amount);
+				shifts.push_back(shift);
+			}
+		}
+	}
+
+	blendPalettes(colours.data(), blend.data(), amounts.data(), shifts.size(), size, shifts.data());
+
+	// Then each segment is the suit it started as with the new colours put in, written all at once
+	wxByte segment[0x220];
+	size_t next = 0;
+	for (int s = 0; s < 3; s++) {
+		for (int i = 0; i < 8; i++) {
+			memcpy(segment, chosen[s][i], _paletteSizes[i]);
+			for (int line = 0; line < _paletteSizes[i]; line += _paletteStrides[i]) {
+				for (int j = 1; j <= size; j++) {
+					segment[line + (j * 2)] = colours[next] & 0xFF;
+					segment[line + (j * 2) + 1] = colours[next] >> 8;
+					next++;
+				}
+			}
+			_rom->setBytes(addresses[s][i], segment, _paletteSizes[i]);
+		}
+	}
+}
+
+void Generator::indexEnemyPalettes() {
+	TRACE_SCOPE("indexEnemyPalettes");
+
+	_enemyPalettes.clear();
+
+	// The table goes until the end of the bank, or until something that can't be a header
+	for (uint64_t header = kAddrEnemyPal - kEnemyHeaderPal; (header + kEnemyHeaderSize) <= kEnemyHeadersEnd; header += kEnemyHeaderSize) {
+		uint16_t pointer = _rom->getByte(header + kEnemyHeaderPal) | (_rom->getByte(header + kEnemyHeaderPal + 1) << 8);
+		wxByte bank = _rom->getByte(header + kEnemyHeaderBank);
+		if ((pointer < kLoRomBankSize) || (bank < kEnemyBankFirst) || (bank > kEnemyBankLast)) {
+			break;
+		}
+
+		uint64_t offset = Rom::snesToPc((bank << 16) | pointer);
+		if ((offset + (kEnemyPalColours * 2)) <= _rom->_length) {
+			_enemyPalettes.push_back(offset);
+		}
+	}
+
+	// Lots of enemies share a palette, and each one should only be changed once
+	std::sort(_enemyPalettes.begin(), _enemyPalettes.end());
+	_enemyPalettes.erase(std::unique(_enemyPalettes.begin(), _enemyPalettes.end()), _enemyPalettes.end());
+}
+
+void Generator::shuffleEnemyPalettes() {
+	TRACE_SCOPE("shuffleEnemyPalettes");
+
+	if (_enemyPalettesPath != _settings.basePath) {
+		indexEnemyPalettes();
+		_enemyPalettesPath = _settings.basePath;
+	}
+
+	// Colour 0 is transparent, so it's only the other 15 of each palette that get changed
+	const int size = kEnemyPalColours - 1;
+	int count = _enemyPalettes.size();
+	std::vector<uint16_t> colours(count * size);
+	std::vector<PaletteShift> shifts(count);
+
+	// Every palette gets its own hue, and somewhere between 3/4 and 5/4 of the chroma it had
+	Rng rng = stream(kStreamEnemies);
+	for (int p = 0; p < count; p++) {
+		const wxByte *palette = _rom->_dataBuffer + _enemyPalettes[p] + 2;
+		for (int i = 0; i < size; i++) {
+			colours[(p * size) + i] = palette[i * 2] | (palette[(i * 2) + 1] << 8);
+		}
+		shifts[p].hue = rng.next() >> (64 - kFixedShift);
+		shifts[p].chroma = ((kFixedOne * 3) / 4) + (rng.next() >> (64 - kFixedShift + 1));
+	}
+
+	shiftPalettes(colours.data(), count, size, shifts.data());
+
+	wxByte bytes[size * 2];
+	for (int p = 0; p < count; p++) {
+		for (int i = 0; i < size; i++) {
+			bytes[i * 2] = colours[(p * size) + i] & 0xFF;
+			bytes[(i * 2) + 1] = colours[(p * size) + i] >> 8;
+		}
+		_rom->setBytes(_enemyPalettes[p] + 2, bytes, size * 2);
+	}
+}
+
+void Generator::shuffleFontText() {
+	TRACE_SCOPE("shuffleFontText");
+
+	// First we want a vector of the possible patches to apply
+	wxVector<wxByte *> fontText;
+	fontText.push_back(_gfxFontBrail);
+	fontText.push_back(_gfxFontUpsideDown);
+	fontText.push_back(_gfxFontGalactic);
+	fontText.push_back(_gfxFontWingDings);
+	fontText.push_back(_gfxFontRuneScape);
+	fontText.push_back(_gfxFontStarWars);
+	fontText.push_back(_gfxFontBadKerning);
+	fontText.push_back(_gfxFontChozo);
+	fontText.push_back(_gfxFontGreek);
+	fontText.push_back(_gfxFontHylian);
+	fontText.push_back(_gfxFontKlingon);
+	fontText.push_back(_gfxFontLeetSpeak);
+	fontText.push_back(_gfxFontLotR);
+	fontText.push_back(_gfxFontMinecraft);
+
+	int randNum = stream(kStreamFonts).derive(1).below(fontText.size());
+
+	// Then we pick one at random to apply
+	_rom->applyPatch(fontText[randNum]);
+}
+
+void Generator::shuffleFontNumbers() {
+	TRACE_SCOPE("shuffleFontNumbers");
+
+	// First we want a vector of the possible patches to apply
+	wxVector<wxByte *> fontNumbers;
+	//fontNumbers.push_back(_gfxFontDots);
+	fontNumbers.push_back(_gfxFontRoman);
+	//fontNumbers.push_back(_gfxFontBars);
+	fontNumbers.push_back(_gfxFontAnalogue);
+	fontNumbers.push_back(_gfxFontDice);
+	fontNumbers.push_back(_gfxFontBinary);
+	//fontNumbers.push_back(_gfxFontAscii);
+	fontNumbers.push_back(_gfxFontTallies);
+	//fontNumbers.push_back(_gfxFontElements);
+
+	int randNum = stream(kStreamFonts).below(fontNumbers.size());
+
+	// Then we pick one at random to apply
+	_rom->applyPatch(fontNumbers[randNum]);
+}
\ No newline at end of file
@@ -0,0 +1,624 @@
+// Project Base Randomizer
+
+#ifndef RANDO_GENERATOR_H
+#define RANDO_GENERATOR_H
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include <wx/wxprec.h>
+
+#ifndef WX_PRECOMP
+	#include <wx/wx.h>
+#endif
+
+#include <wx/vector.h>
+
+#include <algorithm>
+#include <bitset>
+#include <stack>
+#include <unordered_set>
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+
+#include "rom.h"
+#include "rng.h"
+
+struct Node;
+struct Location;
+struct LocationTrees;
+
+enum StorageType {
+	kNormal,
+	kChozo,
+	kHidden
+};
+
+enum Major {
+	kMinor,
+	kMajor
+};
+
+struct Item {
+	wxString name;
+	uint16_t value;
+	int weight;
+	int number;
+	Major major = kMajor;
+	Item() {}
+	Item(wxString n, uint16_t v, int w) {
+		name = n;
+		value = v;
+		weight = w;
+		number = 1;
+	}
+};
+
+struct Player {
+	uint64_t collected 	 = 0;
+	bool majorMinor  = false;
+	int energyLow 	 = 0;
+	int energyMed 	 = 0;
+	int energyHigh 	 = 0;
+	int missilesLow  = 0;
+	int missilesMed  = 0;
+	int missilesHigh = 0;
+};
+
+enum ObjectType {
+	kObjNone,
+	kObjNatural,
+	kObjMetal,
+	kObjStone,
+	kObjGlass,
+	kObjWater
+};
+
+enum Relationship {
+	kRelNone,
+	kRelCompliment,
+	kRelAnalogous,
+	kRelTriadic,
+	kRelTetradic
+};
+
+/* Palette templates
+ * A PalColour describes how one colour (or gradient) of a tileset palette gets picked.
+ * The constructors are all constexpr so that the templates can be compile time tables.
+ */
+struct PalColour {
+	int index = 0;
+	ObjectType object = kObjNone;
+	Relationship relation = kRelNone;
+	int reference = -1;
+	float saturation = 1;
+	int gradient = 0;
+	int brightnessS = 100;
+	int brightnessE = -1;
+	float hueShift = 0;
+	bool background = false;
+	int tileset = -1;
+	bool hardCoded = false;
+	Rgb colour = kRgbBlack;
+
+	constexpr PalColour(int i, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE, float shift, int tile)
+		: index(i), object(obj), relation(rel), reference(ref), saturation(sat), gradient(grad), brightnessS(bS), brightnessE(bE), hueShift(shift), tileset(tile) {}
+
+	constexpr PalColour(int i, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE, float shift)
+		: index(i), object(obj), relation(rel), reference(ref), saturation(sat), gradient(grad), brightnessS(bS), brightnessE(bE), hueShift(shift) {}
+
+	constexpr PalColour(int i, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE)
+		: index(i), object(obj), relation(rel), reference(ref), saturation(sat), gradient(grad), brightnessS(bS), brightnessE(bE) {}
+
+	constexpr PalColour(int i, bool bg, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE)
+		: index(i), object(obj), relation(rel), reference(ref), saturation(sat), gradient(grad), brightnessS(bS), brightnessE(bE), background(bg) {}
+
+	constexpr PalColour(int i, bool bg, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE, float shift)
+		: index(i), object(obj), relation(rel), reference(ref), saturation(sat), gradient(grad), brightnessS(bS), brightnessE(bE), hueShift(shift), background(bg) {}
+
+	constexpr PalColour(int i, int ref, int bS)
+		: index(i), reference(ref), brightnessS(bS) {}
+
+	constexpr PalColour(int i, int ref, int grad, int bS, int bE)
+		: index(i), reference(ref), gradient(grad), brightnessS(bS), brightnessE(bE) {}
+
+	constexpr PalColour(int i, int ref, int grad, int bS, int bE, float shift)
+		: index(i), reference(ref), gradient(grad), brightnessS(bS), brightnessE(bE), hueShift(shift) {}
+
+	constexpr PalColour(int i, Rgb hard)
+		: index(i), hardCoded(true), colour(hard) {}
+
+	constexpr PalColour(int i, Rgb hard, int grad, int bS, int bE)
+		: index(i), gradient(grad), brightnessS(bS), brightnessE(bE), hardCoded(true), colour(hard) {}
+};
+
+// A whole tileset's template, which is just a table of PalColours
+struct TilesetTemplate {
+	const PalColour *colours;
+	int size;
+};
+
+template <size_t N>
+constexpr TilesetTemplate tilesetTemplate(const PalColour (&colours)[N]) {
+	return {colours, (int) N};
+}
+
+/* Glow and heat palettes
+ * The game animates some colours by cycling through a set of palettes, and all of
+ * them are made from a few colours of a tileset getting lighter or darker each
+ * frame. So each one is just a row in a table, with a curve that says how much
+ * lighter (or darker) every frame is.
+ */
+enum GlowValues {
+	kGlowMaxFrames = 16,
+	kGlowMaxColours = 8
+};
+
+struct GlowCurve {
+	int frames;
+	int amount[kGlowMaxFrames];		// The lightness amount for each frame (100 is unchanged)
+	int times[kGlowMaxFrames];		// How many times in a row that amount is applied
+};
+
+struct GlowRow {
+	uint64_t addr;					// Where the first frame goes
+	int stride;						// How far apart the frames are
+	int tileset;					// The tileset and first colour it takes colours from
+	int index;
+	int count;						// How many colours in a row
+	const GlowCurve *curve;
+};
+
+/* FX1 entries
+ * Every room state points to a list of these in bank 83, which is what gives a room its
+ * liquid, fog, rain and so on. Each entry is 16 bytes, the last one in a list is the one
+ * for door 0 (the default), and a list with no FX at all is just an FFFF.
+ */
+enum FX1Values {
+	kAddrFX1Start	= 0x018000,
+	kAddrFX1End		= 0x0188FC,
+	kFX1EntrySize	= 0x10,
+	kFX1NoFX		= 0xFF,		// The first byte of the FFFF that means a room has no FX
+	kFX1TypeLast	= 0x0C		// Lava, acid, water, spores, rain and fog are 2 to 0C, anything higher is something special
+};
+
+struct FX1Entry {
+	uint64_t offset;				// Where the entry is in the rom
+	uint16_t list;					// The FX pointer (in bank 83) of the list this entry is in, which is what the room states use
+	uint16_t door;					// The door this entry is for, 0 if it's the default for the room
+	uint16_t baseY;					// The height of the liquid
+	uint16_t targetY;				// The height it moves to, FFFF if it doesn't move
+	uint16_t velocity;
+	wxByte timer;					// How long before it starts moving
+	wxByte type;
+	wxByte layerA;					// Blending of the default layer
+	wxByte layerB;					// Blending of the FX layer
+	wxByte liquidOptions;
+	wxByte paletteFX;
+	wxByte animatedTiles;
+	wxByte blend;					// The colour the FX blends with
+};
+
+/* Rooms
+ * The flood planner needs to know which item locations are in the rooms that use each
+ * FX1 list, and how tall those rooms are. That comes from the room headers in bank 8F,
+ * where every state of a room points to its FX1 list and to its PLM set (the items).
+ */
+enum RoomValues {
+	kAddrRoomsStart		= 0x78000,	// Bank 8F
+	kAddrRoomsEnd		= 0x80000,
+	kRoomHeaderSize		= 11,
+	kRoomStateSize		= 26,
+	kRoomStateLevelData	= 0,		// Where things are in a room state
+	kRoomStateTileset	= 3,
+	kRoomStateFX1		= 6,
+	kRoomStatePLM		= 20,
+	kRoomMaxStates		= 16,
+	kRoomMaxSize		= 16,		// Rooms are at most 16 screens across or down
+	kRoomScreenHeight	= 0x100,
+	kPLMEntrySize		= 6,
+	kNumTilesets		= 29
+};
+
+// The state condition codes, each one followed by some argument bytes and then a pointer to its state
+enum RoomStateCode {
+	kStateDefault		= 0xE5E6,	// The last one, with the default state right after it
+	kStateDoor			= 0xE5EB,
+	kStateMainBoss		= 0xE5FF,
+	kStateEvent			= 0xE612,
+	kStateBoss			= 0xE629,
+	kStateMorph			= 0xE640,
+	kStateMorphMissiles	= 0xE652,
+	kStatePowerBombs	= 0xE669,
+	kStateSpeedBooster	= 0xE678
+};
+
+// Reads the states of the room header at header (the default state last), returning how many there are, or 0 if it isn't a room header
+int readRoomStates(const wxByte *rom, uint64_t header, uint64_t states[kRoomMaxStates]);
+
+struct FX1Room {
+	uint16_t list;					// The FX1 list (same as FX1Entry::list)
+	int height = 0;					// The height of the tallest room using it, in screens
+	std::vector<long> locations;	// The item locations in any room state that uses it
+};
+
+// An item the logic put somewhere, kept so that anything after the logic can check what is still reachable
+struct PlacedItem {
+	long addr;
+	uint64_t item;
+	Node *requirements;
+};
+
+// The palette options, read from the window once so that palettes can be made off the main thread
+struct PaletteOptions {
+	bool silhouette = false;
+	bool continuity = true;
+	bool greyscale = false;
+};
+
+/* Rando Settings
+ * Everything the generation reads from the window, taken all at once when
+ * randomize is pressed. The worker thread only ever looks at this copy,
+ * so the window can keep changing (or closing) while a seed is being made.
+ * Everything starts out the same as the window does (which is casual), so
+ * anything that only fills in some of it (the daemon, the bench) gets the same seed
+ */
+struct RandoSettings {
+	wxString basePath;
+	wxString fileName;				// Empty means no file gets written, like for the daemon
+	long seed = 0;
+	bool vanilla = false;
+	bool skipCeres = true;
+	bool mysteryItemGfx = false;
+	bool gravityHeat = true;
+	bool partyRando = false;
+	uint16_t options1 = 0xFDF9;
+	uint16_t options2 = 0x0314;
+	int pauseDefault = 0;
+	int hud = 2;
+	int bomb = 2;
+	bool shuffleTilePal = false;
+	PaletteOptions palette;
+	Rgb hud1 = kRgbWhite;
+	Rgb hud2 = Rgb(0x28, 0x38, 0x88);
+	bool shuffleEnemyPal = false;
+	bool shuffleBeamPal = false;
+	bool shuffleSuitPal = false;
+	bool generateSuitPal = false;
+	bool includeVanilla = true;
+	bool includePBExpanded = false;
+	bool includeHacks = false;
+	bool shuffleFontNGfx = false;
+	bool shuffleFontTGfx = false;
+	uint64_t tricks = 0x80000000;
+	bool majorMinor = false;
+	int energyLow = 1;
+	int energyMed = 3;
+	int energyHigh = 5;
+	int missilesLow = 2;
+	int missilesMed = 8;
+	int missilesHigh = 15;
+	bool shuffleFX1 = false;
+	bool floodMode = false;
+	bool logFile = false;
+};
+
+/* Stages
+ * The parts of a seed that get kept between seeds. Each one
+ * has a key made from everything it depends on, and as long as
+ * that stays the same, what it wrote to the rom can just be
+ * written again instead of making it from scratch
+ */
+enum Stage {
+	kStageTilePalettes,
+	kStagePalettes,
+	kStageFonts,
+	kStageItems,
+	kStageFX,
+	kNumStages
+};
+
+struct StageCache {
+	bool valid = false;
+	wxString key;
+	std::vector<RomWrite> writes;
+	std::vector<FreeRegion> freeSpace;	// What was still free after it
+	wxString log;						// And what it added to the log
+};
+
+// The streams of random numbers a seed is made from. New ones go on the end, so the others stay the same
+enum RngStream {
+	kStreamLogic,
+	kStreamTilesets,
+	kStreamEnemies,
+	kStreamBeams,
+	kStreamSuits,
+	kStreamFonts,
+	kStreamFX,
+	kStreamFlood
+};
+
+// How a seed finished, sent along with the done event
+enum RandoResult {
+	kRandoFinished,
+	kRandoCancelled
+};
+
+// We're going to need a dictionary for the items
+WX_DECLARE_HASH_MAP(uint64_t, Item, wxIntegerHash, wxIntegerEqual, ItemDict);
+
+enum Address {
+	kAddrItems    = 0xF0AC,
+	kAddrOptions1 = 0xF0E2,
+	kAddrOptions2 = 0xF0E9,
+	kAddrPause    = 0xF0F0,
+	kAddrHud      = 0xF0F7,
+	kAddrBombTime = 0xF0FE,
+	kAddrButtons  = 0x0000,
+	kAddrGfxPal   = 0x7E6A8,
+	kAddrEnemyPal = 0x104EC1,
+	kAddrBeamPal  = 0x8763A,
+	kAddrSuits	  = 0x20717,
+	kAddrSpore    = 0x78642,
+	kAddrHeat	  = 0x6E37D
+};
+
+enum EnemyHeaderValues {
+	kEnemyHeaderSize	= 0x40,		// The enemy headers are one after another in bank A0, and kAddrEnemyPal is the palette pointer of the first one
+	kEnemyHeaderPal		= 0x02,		// Where the palette pointer is in a header
+	kEnemyHeaderBank	= 0x0C,		// Where the bank of the enemy is in a header (the palette is in that bank too)
+	kEnemyHeadersEnd	= 0x108000,	// The end of bank A0
+	kEnemyBankFirst		= 0xA2,		// Enemy code and palettes are all in banks A2 to B3
+	kEnemyBankLast		= 0xB3,
+	kEnemyPalColours	= 16
+};
+
+/* Logic counters
+ * What the logic actually did to place the items of a seed, so
+ * we can see which settings make the placement degenerate. The
+ * logic fills in its own copy with plain increments (only one
+ * thread ever runs it), and LogicTotals adds them up across any
+ * number of seeds and threads. Building with -DRANDO_NO_COUNTERS
+ * leaves them all at 0.
+ */
+enum LogicCounter {
+	kCountScans,					// Step 2 passes over the remaining locations
+	kCountNodeVisits,				// Nodes checkRequirements looked at
+	kCountRequirementSets,			// Sets in requirementsList, added up over every scan
+	kCountMaxRequirementSets,		// The most it ever had at once
+	kCountEmptyScans,				// Scans with no requirements left, so Step 3 had nothing to do
+	kCountFallbacks,				// Step 3 couldn't use any set, so the last one got used again
+	kCountFailures,					// Runs that gave up because there weren't enough locations
+	kNumLogicCounters
+};
+
+extern const char *kLogicCounterNames[kNumLogicCounters];
+
+struct LogicCounters {
+	uint64_t seeds = 0;
+	uint64_t counts[kNumLogicCounters] = {};
+
+	static wxString csvHeader();
+	wxString csvRow(wxString name) const;
+};
+
+class LogicTotals {
+public:
+	LogicTotals();
+
+	void add(const LogicCounters &counters);
+	LogicCounters get() const;
+
+private:
+	std::atomic<uint64_t> _seeds;
+	std::atomic<uint64_t> _counts[kNumLogicCounters];
+};
+
+#ifndef RANDO_NO_COUNTERS
+	#define LOGIC_COUNT(counter, amount) (_counters.counts[counter] += (amount))
+	#define LOGIC_MAX(counter, value) (_counters.counts[counter] = std::max<uint64_t>(_counters.counts[counter], (value)))
+#else
+	#define LOGIC_COUNT(counter, amount) ((void) 0)
+	#define LOGIC_MAX(counter, value) ((void) 0)
+#endif
+
+/* Difficulty presets
+ * What picking a difficulty sets the tricks and energy to.
+ * The window and the bench both use the same table
+ */
+enum Difficulty {
+	kDifficultyCasual,
+	kDifficultyNormal,
+	kDifficultySpeedrunner,
+	kDifficultyHard,
+	kDifficultyVeryHard,
+	kNumDifficulties
+};
+
+struct DifficultyPreset {
+	const char *name;
+	bool gravityHeat;
+	int energyLow;
+	int energyMed;
+	int energyHigh;
+	uint64_t tricks;
+};
+
+extern const DifficultyPreset kDifficultyPresets[kNumDifficulties];
+
+/* Generator
+ * Everything that goes into making a seed, without any of the window.
+ * It works only from the settings it's given, so anything that can fill
+ * those in (the window, the bench) can make seeds with it
+ */
+class Generator {
+public:
+	Generator();
+	virtual ~Generator() {
+		freeLocationTrees();
+		delete _rom;
+	}
+
+	void loadRom(wxString path);					// Loads the base rom, and forgets any stages made from the last one
+	void loadRom(const Rom &base);					// The same, but sharing the bytes of a rom that's already loaded
+	bool makeSeed();								// Makes a seed from _settings, returning false if it was cancelled
+
+protected:
+	// The rom is a member so that it can be read/written from anywhere
+	Rom *_rom = nullptr;
+
+	// The log also needs to be written to from anywhere
+	wxString _log = "";
+
+	// This object represents the player. It needs to be outside of the logic so that tricks can be applied to it
+	Player _player;
+
+	// Every enemy palette the enemy headers point to, which only has to be found once for each base rom
+	std::vector<uint64_t> _enemyPalettes;
+	wxString _enemyPalettesPath = "";
+
+	// And the same for the FX1 entries, as they are in the base rom
+	std::vector<FX1Entry> _fx1Entries;
+	std::vector<FX1Room> _fx1Rooms;
+	wxString _fx1Path = "";
+
+	// Where the logic put every item, and what the player started with (the tricks)
+	std::vector<PlacedItem> _placed;
+	uint64_t _startCollected = 0;
+
+	// What the logic did for the last seed
+	LogicCounters _counters;
+
+	// Every location with its requirements already parsed, for the tricks, energy and missiles of the last seed
+	LocationTrees *_locationTrees = nullptr;
+
+	// The settings the seed is being made from
+	RandoSettings _settings;
+	std::atomic<bool> _cancel{false};
+
+	// Where the logic gets its random numbers from
+	Rng _logicRng = Rng(0);
+
+	// Each stage of the last seed, so only the ones that have changed need making again
+	StageCache _stages[kNumStages];
+
+	Palette128 _generatedPalettes[kNumTilesets];		// The tileset palettes of the last seed
+
+	// Lastly we have the patches and palettes
+	// These are the palettes for the suits that get randomly applied
+	int _paletteSizes[8] = {0x20, 0x20 * 8, 0x20 * 4, 0x20 * 4, 0x20 * 4, 0x20 * 4, 0x20, 0x220};
+	int _paletteStrides[8] = {0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22};	// The last one has a 2 byte instruction after each palette line
+	int _paletteAddrPower[8]   = {0xD9400, 0xD9820, 0xD9B20, 0xD9BA0, 0xD9C20, 0xD9CA0, 0x6DC09, 0x6E466};
+	int _paletteAddrVaria[8]   = {0xD9520, 0xD9920, 0xD9D20, 0xD9DA0, 0xD9E20, 0xD9EA0, 0x6DD6F, 0x6E692};
+	int _paletteAddrGravity[8] = {0xD9800, 0xD9A20, 0xD9F20, 0xD9FA0, 0xDA020, 0xDA0A0, 0x6DED5, 0x6E8BE};
+
+	// Vanilla palettes
+	wxByte **_palettePower;
+	wxByte **_paletteVaria;
+	wxByte **_paletteGravity;
+
+	// PB Extended palettes
+	wxByte **_paletteSlate;
+	wxByte **_paletteWhite;
+	wxByte **_paletteGreen;
+	wxByte **_paletteGrime;
+	wxByte **_palettePhazon;
+	wxByte **_paletteFusion;
+
+	// Hack palettes
+	wxByte **_palettePhazonP;
+	wxByte **_palettePhazonV;
+	wxByte **_palettePhazonG;
+	wxByte **_paletteHallowEve;
+	wxByte **_paletteFinalStandP;
+	wxByte **_paletteFinalStandV;
+	wxByte **_paletteFinalStandG;
+	wxByte **_paletteHangTimeP;
+	wxByte **_paletteHangTimeG;
+	wxByte **_paletteLostWorldP;
+	wxByte **_paletteLostWorldG;
+	wxByte **_paletteVanillaPlus;
+	wxByte **_paletteHyperP;
+	wxByte **_paletteHyperV;
+	wxByte **_paletteHyperG;
+	wxByte **_paletteIceMetalP;
+	wxByte **_paletteIceMetalV;
+	wxByte **_paletteIceMetalG;
+
+	// These are the patches needed for the rom, in the form of byte buffers
+	wxByte *_patchEvents;
+	wxByte *_patchSkipCeres;
+	wxByte *_patchEffects;
+
+	// These are patches needed for fixing things in the vanilla map version of PB
+	wxByte *_patchDashBall;
+
+	// These are also patches, but specifically for gfx data
+	wxByte *_gfxFontBrail;
+	wxByte *_gfxFontUpsideDown;
+	wxByte *_gfxFontGalactic;
+	wxByte *_gfxFontWingDings;
+	wxByte *_gfxFontRuneScape;
+	wxByte *_gfxFontStarWars;
+	wxByte *_gfxFontBadKerning;
+	wxByte *_gfxFontChozo;
+	wxByte *_gfxFontGreek;
+	wxByte *_gfxFontHylian;
+	wxByte *_gfxFontKlingon;
+	wxByte *_gfxFontLeetSpeak;
+	wxByte *_gfxFontLotR;
+	wxByte *_gfxFontMinecraft;
+	wxByte *_gfxFontDots;
+	wxByte *_gfxFontRoman;
+	wxByte *_gfxFontBars;
+	wxByte *_gfxFontAnalogue;
+	wxByte *_gfxFontDice;
+	wxByte *_gfxFontBinary;
+	wxByte *_gfxFontAscii;
+	wxByte *_gfxFontTallies;
+	wxByte *_gfxFontElements;
+	wxByte *_gfxMysteryItem;
+
+	// Seed functions
+	bool runStage(int stage, wxString key, std::function<void()> make);
+	void resetPlayer();
+	Rng stream(RngStream part);
+	bool cancelled();
+	virtual void progress(int percent, wxString phase) {}	// Called as each part of the seed starts
+
+	// Init functions
+	void initializePatches();
+
+	// Other feature functions
+	void makeNewTilesetPalettes();
+	void tilesetPalettes(const RandoSettings &settings, const Rng &paletteRng, Palette128 palettes[kNumTilesets]);
+	void fixHeatPalettes(Rgb *tilesets[29]);
+	void fixGlowPalettes(Rgb *tilesets[29]);
+	void writeGlowPalettes(Rgb *tilesets[29], const GlowRow *rows, int count);
+	void processTilesetTemplate(Rgb *tilesets[29], const TilesetTemplate templates[29], int t, const PaletteOptions &options, Rng &rng);
+	void makeTilesetPalettes(Rgb *tilesets[29], const RandoSettings &settings, const Rng &paletteRng);
+	void writeLockedPaletteColours(Rgb *tilesets[29], const RandoSettings &settings);
+	void indexEnemyPalettes();
+	void shuffleEnemyPalettes();
+	void shuffleBeamPalettes();
+	void shuffleSuitPalettes();
+	void generateSuitPalettes(wxByte **chosen[3], const wxVector<wxByte **> &included);
+	void shuffleFontText();
+	void shuffleFontNumbers();
+	void indexFX1();
+	void indexFX1Rooms();
+	void addRoomState(uint64_t state, int height);
+	void writeFX1(const std::vector<FX1Entry> &entries);
+	void shuffleFX1(std::vector<FX1Entry> &entries);
+	void floodFX1(std::vector<FX1Entry> &entries);
+
+	// Logic functions
+	void logic();
+	bool checkRequirements(Node *node, ItemDict itemPool);
+	std::vector<bool> reachableLocations(const std::vector<uint64_t> &extra);
+	void setItem(wxVector<Location> &locations, int pos, uint64_t item, ItemDict &itemPool, int &allWeights);
+	void resetLocationsAndItems(wxVector<Location> &locations, wxVector<Location> &locationsMinor, ItemDict &itemPool, int &allWeights);
+	void buildLocationTrees();
+	void freeLocationTrees();
+};
+
+#endif
@@ -1,6 +1,7 @@
 // Logic
-#include "rando.h"
+#include "generator.h"
 #include "rom.h"
+#include "trace.h"
 
 // Items as bits for logic expressions
 const uint64_t kRMorphingBall = 0x1;
@@ -215,7 +216,7 @@ struct Location {
 		}
 	}
 
-	void buildItems(Node *node, Player player) {
+	void buildItems(Node *node, Player player, Rng &rng) {
 		// Morph ball has no requirements, so it ends up being null
 		if (node != nullptr) {
 			// Everything else has a valid pointer
@@ -223,43 +224,43 @@ struct Location {
 				if (node->left->bitset >= kRCanWallJump) {
 					if ((node->left->bitset & player.collected) == node->left->bitset) {
 						// If the trick is collected, we want to use the item
-						buildItems(node->right, player);
+						buildItems(node->right, player, rng);
 					}
 
 				} else if (node->right->bitset >= kRCanWallJump) {
 					if ((node->right->bitset & player.collected) == node->right->bitset) {
 						// If the trick is collected, we want to use the item
-						buildItems(node->left, player);
+						buildItems(node->left, player, rng);
 					}
 
 				} else {
-					buildItems(node->left, player);
-					buildItems(node->right, player);
+					buildItems(node->left, player, rng);
+					buildItems(node->right, player, rng);
 				}
 
 			} else if (node->op == '|') {
 				// If one side is a trick and not an item, check if the trick is collected
 				if (node->left->op == '^') {
-					buildItems(node->right, player);
+					buildItems(node->right, player, rng);
 				
 				} else if (node->right->op == '^') {
-					buildItems(node->left, player);
+					buildItems(node->left, player, rng);
 				
 				} else if ((node->left->bitset >= kRCanWallJump) && ((node->left->bitset & player.collected) != node->left->bitset)) {
 						// If the trick is not collected, we want to use the item
-						buildItems(node->right, player);
+						buildItems(node->right, player, rng);
 
 				} else if ((node->right->bitset >= kRCanWallJump) && ((node->right->bitset & player.collected) != node->right->bitset)) {
 						// If the trick is not collected, we want to use the item
-						buildItems(node->left, player);
+						buildItems(node->left, player, rng);
 
 				// Else we want to randomly choose one of them
 				} else {
-					if ((rand() % 2) == 0) {
-						buildItems(node->left, player);
+					if (rng.below(2) == 0) {
+						buildItems(node->left, player, rng);
 				
 					} else {
-						buildItems(node->right, player);
+						buildItems(node->right, player, rng);
 					}
 				}
 			} else {
@@ -270,20 +271,56 @@ struct Location {
 		}
 	}
 
+	// Only the tree gets made here, since the item set uses the logic's random numbers and so each seed makes its own (with buildItems)
 	Location(Player p, long a, wxString n, StorageType h, Major m, wxString r) {
 		name = n;
 		addr = a;
 		hidden = h;
 		major = m;
-		std::cout << "building tree for " << n << std::endl;
+		TRACE_LOG(kLogDebug, "building tree for " << n);
 		requirements = buildTree(r, p);
-		buildItems(requirements, p);		
 	}
 
 	~Location() {
 	}
 };
 
+/* Location trees
+ * Parsing the requirement strings is most of what resetting the locations
+ * costs, but the trees only depend on the tricks, energy and missiles (which
+ * are all in the player). So the locations of both maps are kept along with
+ * their trees, and only made again when one of those changes. The trees
+ * belong to this, and every copy of a location just points at them.
+ */
+struct LocationTrees {
+	Player player;
+	std::vector<Location> vanilla;
+	std::vector<Location> pb;
+
+	~LocationTrees() {
+		clear();
+	}
+
+	void clear() {
+		for (Location &location : vanilla) {
+			delete location.requirements;
+		}
+
+		for (Location &location : pb) {
+			delete location.requirements;
+		}
+
+		vanilla.clear();
+		pb.clear();
+	}
+};
+
+// Whether two players would make the same trees
+static bool sameTrees(const Player &a, const Player &b) {
+	return (a.collected == b.collected) && (a.majorMinor == b.majorMinor) && (a.energyLow == b.energyLow) && (a.energyMed == b.energyMed)
+		&& (a.energyHigh == b.energyHigh) && (a.missilesLow == b.missilesLow) && (a.missilesMed == b.missilesMed) && (a.missilesHigh == b.missilesHigh);
+}
+
 // To be able to make a set of sets of requirements, we need to make a new hash type that combines them
 struct RequirementHash {
 	std::size_t operator()(const std::unordered_set<uint64_t, wxIntegerHash> &set) const {
@@ -297,8 +334,58 @@ struct RequirementHash {
 	}
 };
 
+const char *kLogicCounterNames[kNumLogicCounters] = {"scans", "node_visits", "requirement_sets", "max_requirement_sets", "empty_scans", "fallbacks", "failures"};
+
+wxString LogicCounters::csvHeader() {
+	wxString header = "name,seeds";
+	for (int c = 0; c < kNumLogicCounters; c++) {
+		header += wxString::Format(",%s", kLogicCounterNames[c]);
+	}
+	return header;
+}
+
+wxString LogicCounters::csvRow(wxString name) const {
+	wxString row = wxString::Format("%s,%llu", name, (unsigned long long) seeds);
+	for (int c = 0; c < kNumLogicCounters; c++) {
+		row += wxString::Format(",%llu", (unsigned long long) counts[c]);
+	}
+	return row;
+}
+
+LogicTotals::LogicTotals() {
+	_seeds = 0;
+	for (int c = 0; c < kNumLogicCounters; c++) {
+		_counts[c] = 0;
+	}
+}
+
+void LogicTotals::add(const LogicCounters &counters) {
+	_seeds.fetch_add(counters.seeds, std::memory_order_relaxed);
+	for (int c = 0; c < kNumLogicCounters; c++) {
+		if (c != kCountMaxRequirementSets) {
+			_counts[c].fetch_add(counters.counts[c], std::memory_order_relaxed);
+			continue;
+		}
+
+		// The max is the only one that isn't just added on
+		uint64_t current = _counts[c].load(std::memory_order_relaxed);
+		while ((current < counters.counts[c]) && (_counts[c].compare_exchange_weak(current, counters.counts[c], std::memory_order_relaxed) == false)) {}
+	}
+}
+
+LogicCounters LogicTotals::get() const {
+	LogicCounters counters;
+	counters.seeds = _seeds.load(std::memory_order_relaxed);
+	for (int c = 0; c < kNumLogicCounters; c++) {
+		counters.counts[c] = _counts[c].load(std::memory_order_relaxed);
+	}
+	return counters;
+}
+
 // Here's where the actual logic happens
-void RandoFrame::logic() {
+void Generator::logic() {
+	TRACE_SCOPE("logic");
+
 	// Locations
 	wxVector<Location> locations;
 	wxVector<Location> locationsMinor;
@@ -314,13 +401,28 @@ void RandoFrame::logic() {
 	int allLocationWeights = 0;
 	int allWeights = 0;
 
+	// Everything the logic picks comes from its own stream, so nothing else in the seed can change where the items go
+	_logicRng = stream(kStreamLogic);
+	_counters = LogicCounters();
+	_counters.seeds = 1;
+
 	/* --- Step 1 ---
 	 * initialize the locations and item pool and
 	 * build the expression trees and sets for each location
 	 */
 	resetLocationsAndItems(locations, locationsMinor, itemPool, allWeights);
 
+	// Anything after the logic that needs to know where the items went (like flood mode) gets it from here
+	_placed.clear();
+	_startCollected = _player.collected;
+
 	while (locations.size() > 0) {
+		// Each pass is a good place to stop if the seed has been cancelled, the rom gets thrown away anyway
+		if (cancelled() == true) {
+			return;
+		}
+		LOGIC_COUNT(kCountScans, 1);
+
 		/* --- Step 2 ---
 		 * Find all available locations with the current equipment and
 		 * put them into a new vector. At the same time, find the lowest
@@ -360,6 +462,9 @@ void RandoFrame::logic() {
 			}
 		}
 
+		LOGIC_COUNT(kCountRequirementSets, requirementsList.size());
+		LOGIC_MAX(kCountMaxRequirementSets, requirementsList.size());
+
 		/* --- Step 3 ---
 		 * We know what the minimum requirements are, so build a list of
 		 * all the sets with that minimum requirement size, then pull
@@ -388,7 +493,12 @@ void RandoFrame::logic() {
 				}
 			}
 
-			int randReq = rand() % weight;
+			// With nothing to pick from, requirements is still the last set
+			if (requirementsListFinal.size() == 0) {
+				LOGIC_COUNT(kCountFallbacks, 1);
+			}
+
+			int randReq = _logicRng.below(weight);
 			for (int i = 0; i < requirementsListFinal.size(); i++) {
 				int itemWeight = 0;
 
@@ -421,11 +531,12 @@ void RandoFrame::logic() {
 					int powerAmt = (*it & 0xF) - (10 - itemPool[kRPowerBombs].number);
 					if (powerAmt > 0) {
 						if (availableLocations.size() < powerAmt) {
-							std::cout << "not enough locations for setting power bombs" << std::endl;
+							TRACE_LOG(kLogWarning, "not enough locations for setting power bombs");
+							LOGIC_COUNT(kCountFailures, 1);
 							return;
 						}
 						for (int i = 0; i < powerAmt; i++) {
-							pos = rand() % availableLocations.size();
+							pos = _logicRng.below(availableLocations.size());
 							setItem(availableLocations, pos, kRPowerBombs, itemPool, allWeights);
 						}
 					}
@@ -434,17 +545,18 @@ void RandoFrame::logic() {
 					int energyAmt = (*it & 0xF) - (14 - itemPool[kREnergy].number);
 					if (energyAmt > 0) {
 						if (availableLocations.size() < energyAmt) {
-							std::cout << "not enough locations for setting energy" << std::endl;
+							TRACE_LOG(kLogWarning, "not enough locations for setting energy");
+							LOGIC_COUNT(kCountFailures, 1);
 							return;
 						}
 						for (int i = 0; i < energyAmt; i++) {
-							pos = rand() % availableLocations.size();
+							pos = _logicRng.below(availableLocations.size());
 							setItem(availableLocations, pos, kREnergy, itemPool, allWeights);
 						}
 					}
 				
 				} else {
-					int randomLocation = rand() % allLocationWeights;
+					int randomLocation = _logicRng.below(allLocationWeights);
 					for (int i = 0; i < availableLocations.size(); i++) {
 						if (randomLocation < availableLocations[i].weight) {
 							pos = i;
@@ -456,6 +568,9 @@ void RandoFrame::logic() {
 					setItem(availableLocations, pos, *it, itemPool, allWeights);
 				}
 			}
+
+		} else {
+			LOGIC_COUNT(kCountEmptyScans, 1);
 		}
 	}
 
@@ -467,7 +582,7 @@ void RandoFrame::logic() {
 	for (int i = 0; i < availableLocations.size(); i++) {
 		ItemDict::iterator it = itemPool.begin();
 		do {
-			int randNum = rand() % allWeights;
+			int randNum = _logicRng.below(allWeights);
 			if (itemPool.size() > 0) {
 				it = itemPool.begin();
 				while ((it != itemPool.end()) && (randNum >= itemPool[it->first].weight)) {
@@ -476,7 +591,7 @@ void RandoFrame::logic() {
 				}
 			}			
 		} while ((_player.majorMinor == true) && (itemPool[it->first].major == kMinor));
-		std::cout << "setting item " << it->first << std::endl;
+		TRACE_LOG(kLogDebug, "setting item " << it->first);
 		setItem(availableLocations, i, it->first, itemPool, allWeights);
 		i--;
 	}
@@ -484,36 +599,39 @@ void RandoFrame::logic() {
 	// And if we are doing major/minor, then we will have locations left in the minor array
 	// So distribute the remaining items into those locations
 	if (locationsMinor.size() != 0) {
-		std::cout << "setting minors now" << std::endl;
+		TRACE_LOG(kLogDebug, "setting minors now");
 		for (int i = 0; i < locationsMinor.size(); i++) {
-			int randNum = rand() % allWeights;
+			int randNum = _logicRng.below(allWeights);
 			if (itemPool.size() > 0) {
 				ItemDict::iterator it = itemPool.begin();
 				while ((it != itemPool.end()) && (randNum >= itemPool[it->first].weight)) {
 					randNum -= itemPool[it->first].weight;
 					it++;
 				}
-				std::cout << "setting item " << it->first << std::endl;
+				TRACE_LOG(kLogDebug, "setting item " << it->first);
 				setItem(locationsMinor, i, it->first, itemPool, allWeights);
 				i--;
 			}
 		}
 	}
 
+#ifndef RANDO_NO_COUNTERS
+	// The counters go at the end of the spoiler log, so anyone looking at a strange seed can see how it got placed
+	_log += "\nLogic counters:\n";
+	for (int c = 0; c < kNumLogicCounters; c++) {
+		_log += wxString::Format("%s: %llu\n", kLogicCounterNames[c], (unsigned long long) _counters.counts[c]);
+	}
+#endif
 }
 
 // This function just sets a given item into a given location, and changes the item weight and item pool accordingly
-void RandoFrame::setItem(wxVector<Location> &locations, int pos, uint64_t item, ItemDict &itemPool, int &allWeights) {
+void Generator::setItem(wxVector<Location> &locations, int pos, uint64_t item, ItemDict &itemPool, int &allWeights) {
 	// We start by actually writing the item into the rom
 	if (itemPool[item].value == 0xEFD8) {
 		// Item is dash ball, which has no chozo/hidden version, so we set it to open
 		_rom->setWord(locations[pos].addr, itemPool[item].value);
 	/*} else if ((itemPool[item].value == 0xEEDB) && (itemPool[kRMissiles].number != 50)) {
-		if (rand() % 1 == 0) {
-			_rom->setWord(locations[pos].addr, 0xEFE0);
-		} else {
-			_rom->setWord(locations[pos].addr, itemPool[item].value + ((locations[pos].hidden * 21) * 4));
-		}*/
+		_rom->setWord(locations[pos].addr, 0xEFE0);*/
 
 	} else {
 		// All other items get hidden or not hidden based on the location
@@ -522,12 +640,12 @@ void RandoFrame::setItem(wxVector<Location> &locations, int pos, uint64_t item,
 	}
 
 	if (item == kRPowerBombs) {
-		std::cout << "Setting a power bomb" << std::endl;
-		std::cout << _player.collected << std::endl;
+		TRACE_LOG(kLogDebug, "Setting a power bomb " << _player.collected);
 	}
 
 	// And adding the entry to the log
 	_log += wxString::Format("Item: %s | Location: %s\n", itemPool[item].name, locations[pos].name);
+	_placed.push_back({locations[pos].addr, item, locations[pos].requirements});
 
 	// Now that we've used the location, we can erase it from the available locations
 	locations.erase(locations.begin() + pos);
@@ -543,7 +661,9 @@ void RandoFrame::setItem(wxVector<Location> &locations, int pos, uint64_t item,
 }
 
 // This is the main function for checking the expression tree requirements
-bool RandoFrame::checkRequirements(Node *node, ItemDict itemPool) {
+bool Generator::checkRequirements(Node *node, ItemDict itemPool) {
+	LOGIC_COUNT(kCountNodeVisits, 1);
+
 	// Morph ball has no requirements, so it ends up being null
 	if (node == nullptr) {
 		return true;
@@ -577,7 +697,14 @@ bool RandoFrame::checkRequirements(Node *node, ItemDict itemPool) {
 	}
 }
 
-void RandoFrame::resetLocationsAndItems(wxVector<Location> &locations, wxVector<Location> &locationsMinor, ItemDict &itemPool, int &allWeights) {
+void Generator::freeLocationTrees() {
+	delete _locationTrees;
+	_locationTrees = nullptr;
+}
+
+void Generator::buildLocationTrees() {
+	TRACE_SCOPE("buildLocationTrees");
+
 	// The rest of these are changeable by the user
 	uint64_t kREnergyLow  = kREnergy + _player.energyLow;
 	uint64_t kREnergyMed  = kREnergy + _player.energyMed;
@@ -840,16 +967,44 @@ void RandoFrame::resetLocationsAndItems(wxVector<Location> &locations, wxVector<
 	Location(_player, 0x7C791, "Space Jump", 									 kNormal, kMajor, wxString::Format("%s & ( %ld | %ld | %ld )", kRCanAccessAquaduct, kRGrappleBeam, kRSpaceJump, kRCanWallJump)),
 	Location(_player, 0x7C4B1, "Missile (Maridia Map Station Missiles Corridor)",kNormal, kMinor, kRCanAccessRB)};
 
+	if (_locationTrees == nullptr) {
+		_locationTrees = new LocationTrees();
+	}
+
+	_locationTrees->clear();
+	_locationTrees->player = _player;
+	_locationTrees->vanilla.assign(std::begin(locationsArrayVanilla), std::end(locationsArrayVanilla));
+	_locationTrees->pb.assign(std::begin(locationsArrayPB), std::end(locationsArrayPB));
+}
+
+void Generator::resetLocationsAndItems(wxVector<Location> &locations, wxVector<Location> &locationsMinor, ItemDict &itemPool, int &allWeights) {
+	TRACE_SCOPE("resetLocationsAndItems");
+
+	if ((_locationTrees == nullptr) || (sameTrees(_locationTrees->player, _player) == false)) {
+		buildLocationTrees();
+	}
+
+	// The item sets get made for both maps, vanilla first, so the logic's random numbers get used the same way they always have
+	std::vector<Location> locationsVanilla = _locationTrees->vanilla;
+	std::vector<Location> locationsPB = _locationTrees->pb;
+	for (Location &location : locationsVanilla) {
+		location.buildItems(location.requirements, _player, _logicRng);
+	}
+
+	for (Location &location : locationsPB) {
+		location.buildItems(location.requirements, _player, _logicRng);
+	}
+
 	// First we want to decide whether to use PB or vanilla locations
 	Location *locationsArray;
-	int numLocations = 105;
+	int numLocations = locationsPB.size();
 
-	if (_romType->GetValue() == false) {
-		locationsArray = locationsArrayPB;
+	if (_settings.vanilla == false) {
+		locationsArray = locationsPB.data();
 
 	} else {
-		locationsArray = locationsArrayVanilla;
-		numLocations = 100;
+		locationsArray = locationsVanilla.data();
+		numLocations = locationsVanilla.size();
 	}
 
 	// If the player chose major/minor, we want to section off the major locations from the minors
@@ -898,7 +1053,7 @@ void RandoFrame::resetLocationsAndItems(wxVector<Location> &locations, wxVector<
 
 	// There are max 50 Missiles
 	itemPool[kRMissiles] = Item("Missile", 0xEEDB, 150);
-	if (_romType->GetValue() == false) {
+	if (_settings.vanilla == false) {
 		itemPool[kRMissiles].number = 50;
 
 	} else {
@@ -923,14 +1078,157 @@ void RandoFrame::resetLocationsAndItems(wxVector<Location> &locations, wxVector<
 
 }
 
+// The same check as checkRequirements, but against a given set of items instead of the item pool, so it can be run after the logic is done
+static bool canReach(Node *node, uint64_t collected, int energy, int powerBombs, bool majorMinor) {
+	if (node == nullptr) {
+		return true;
+	}
 
+	if (node->op == '&') {
+		return canReach(node->left, collected, energy, powerBombs, majorMinor) && canReach(node->right, collected, energy, powerBombs, majorMinor);
 
+	} else if (node->op == '|') {
+		return canReach(node->left, collected, energy, powerBombs, majorMinor) || canReach(node->right, collected, energy, powerBombs, majorMinor);
 
+	} else if (node->op == '^') {
+		return false;
 
+	} else {
+		if ((node->bitset >= kREnergy) && (node->bitset <= kRMissilesAmmo)) {
+			if (majorMinor == true) {
+				return true;
+			}
+			return energy >= (node->bitset & 0xF);
 
+		} else if (node->bitset == kRPBLow) {
+			return powerBombs >= (node->bitset & 0xF);
 
+		} else {
+			return (node->bitset & collected) == node->bitset;
+		}
+	}
+}
 
+// Picks up every placed item it can, over and over until nothing new opens up. Each location also needs one of the items in extra, if it isn't 0
+std::vector<bool> Generator::reachableLocations(const std::vector<uint64_t> &extra) {
+	TRACE_SCOPE("reachableLocations");
+
+	std::vector<bool> reached(_placed.size(), false);
+	uint64_t collected = _startCollected;
+	int energy = 0;
+	int powerBombs = 0;
+
+	bool progress = true;
+	while (progress == true) {
+		progress = false;
+		for (size_t i = 0; i < _placed.size(); i++) {
+			if ((reached[i] == true) || ((extra[i] != 0) && ((extra[i] & collected) == 0))) {
+				continue;
+			}
 
+			if (canReach(_placed[i].requirements, collected, energy, powerBombs, _player.majorMinor) == true) {
+				reached[i] = true;
+				progress = true;
+				collected |= _placed[i].item;
+				if (_placed[i].item == kREnergy) {
+					energy++;
+				} else if (_placed[i].item == kRPowerBombs) {
+					powerBombs++;
+				}
+			}
+		}
+	}
+	return reached;
+}
 
+/* Flood mode
+ * Instead of flooding rooms without looking, each room is tried one at a time, and only
+ * flooded if every item that could be reached before still can be. A deep flood means the
+ * items in the room need gravity suit, and if that would lock something away the room can
+ * still get a shallow flood in its bottom screen, which space jump or hi jump get you out
+ * of too. Each room that does get flooded stays that way for the rooms after it, so it
+ * never has to start over. The logic doesn't know how the rooms connect, so it is only
+ * the items inside a flooded room that get the new requirement. That means a room with
+ * no items in it (most of the corridors and shafts between them) can't be checked at all,
+ * and one of those could be the only way on, so they never get flooded.
+ */
+void Generator::floodFX1(std::vector<FX1Entry> &entries) {
+	TRACE_SCOPE("floodFX1");
+
+	std::unordered_map<long, int> placedIndex;
+	for (size_t i = 0; i < _placed.size(); i++) {
+		placedIndex[_placed[i].addr] = i;
+	}
+
+	std::vector<uint64_t> extra(_placed.size(), 0);
+	std::vector<bool> reached = reachableLocations(extra);
+	int reachable = std::count(reached.begin(), reached.end(), true);
+
+	Rng rng = stream(kStreamFlood);
+	size_t e = 0;
+	for (const FX1Room &room : _fx1Rooms) {
+		size_t first = e;
+		while ((e < entries.size()) && (entries[e].list == room.list)) {
+			e++;
+		}
+
+		bool liquid = false;
+		for (size_t i = first; i < e; i++) {
+			if (entries[i].type <= kFX1TypeLast) {
+				liquid = true;
+			}
+		}
+
+		// About half the rooms that could have water are picked, like before
+		if ((liquid == false) || (rng.below(2) != 0)) {
+			continue;
+		}
+
+		// The items in this room that already have a flood on them are left alone, so each item only ever gets one requirement
+		std::vector<int> items;
+		bool taken = false;
+		for (long addr : room.locations) {
+			std::unordered_map<long, int>::iterator it = placedIndex.find(addr);
+			if (it != placedIndex.end()) {
+				items.push_back(it->second);
+				taken |= (extra[it->second] != 0);
+			}
+		}
+		if ((taken == true) || (items.size() == 0)) {
+			continue;
+		}
 
+		uint16_t baseY = rng.below(0x00FF);
+		uint64_t needs[2] = {kRGravitySuit, kRGravitySuit | kRSpaceJump | kRHiJumpBoots};
+		uint16_t heights[2] = {baseY, (uint16_t) (((room.height - 1) * kRoomScreenHeight) + (kRoomScreenHeight / 2))};
+		int depth = 0;
+		for (; depth < 2; depth++) {
+			for (int i : items) {
+				extra[i] = needs[depth];
+			}
 
+			reached = reachableLocations(extra);
+			if (std::count(reached.begin(), reached.end(), true) == reachable) {
+				break;
+			}
+		}
+
+		if (depth == 2) {
+			for (int i : items) {
+				extra[i] = 0;
+			}
+			continue;
+		}
+
+		for (size_t i = first; i < e; i++) {
+			if (entries[i].type <= kFX1TypeLast) {
+				entries[i].type = 0x06;
+				entries[i].blend = 0x48;
+				entries[i].velocity = (entries[i].velocity & 0x00FF) | 0x5000;
+				entries[i].timer = 0x00;
+				entries[i].baseY = heights[depth];
+				entries[i].targetY = 0xFFFF;
+			}
+		}
+	}
+}
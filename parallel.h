@@ -0,0 +1,42 @@
+#ifndef RANDO_PARALLEL_H
+#define RANDO_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/* Whether parallelFor on this thread just runs everything itself. Each thread has its own,
+ * so something that already runs on a thread per core (like the daemon's workers) can turn
+ * it on for those threads, instead of each of them starting a thread per core every time.
+ */
+inline bool &parallelSerial() {
+	static thread_local bool serial = false;
+	return serial;
+}
+
+/* Runs work(i) for every i from 0 to count - 1, handing them out to as many threads as there
+ * are cores (including the calling one). Returns once they have all finished. The work for each
+ * i must not depend on any other i, because they can run in any order.
+ */
+template <typename Work>
+void parallelFor(size_t count, Work work) {
+	std::atomic<size_t> next(0);
+	auto worker = [&]() {
+		for (size_t i = next++; i < count; i = next++) {
+			work(i);
+		}
+	};
+
+	size_t numThreads = (parallelSerial() == true) ? 1 : std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < numThreads; i++) {
+		threads.push_back(std::thread(worker));
+	}
+	worker();
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+}
+
+#endif
@@ -1,6 +1,6 @@
-#include "rando.h"
+#include "generator.h"
 
-void RandoFrame::initializePatches() {
+void Generator::initializePatches() {
 	/* --- Patches ---
 	 */
 	_patchEvents	= new wxByte[]{0x50, 0x41, 0x54, 0x43, 0x48, 0x07, 0x97, 0x67, 0x00, 0x02, 0x92, 0xfc, 0x07, 0x97, 0xc0, 0x00, 0x02, 0x92, 0xfc, 0x07, 0xfc, 0x92, 0x00, 0x1e, 0xad, 0xa2, 0x09, 0x29, 0x0c, 0x20, 0xd0, 0x0c, 0xad, 0xc8, 0x09, 0xd0, 0x07, 0xad, 0xcc, 0x09, 0xd0, 0x02, 0xf0, 0x07, 0xbd, 0x00, 0x00, 0xaa, 0x4c, 0xe6, 0xe5, 0xe8, 0xe8, 0x60, 0x45, 0x4f, 0x46};
@@ -0,0 +1,225 @@
+// Project Base Randomizer
+#include "preview.h"
+#include "generator.h"
+
+#include <algorithm>
+
+// A long pointer anywhere in the rom
+static uint32_t readLong(const wxByte *rom, uint64_t offset) {
+	return rom[offset] | (rom[offset + 1] << 8) | (rom[offset + 2] << 16);
+}
+
+void TilesetPreview::load(wxString path) {
+	// The preview keeps its own copy, so it never sees what a seed is doing to the main one
+	delete _rom;
+	_rom = new Rom(path);
+
+	// Anything decoded from the last rom is no good anymore
+	_samples.assign(kNumTilesets, Sample());
+	_decoded.assign(kNumTilesets, Decoded());
+	findSamples();
+}
+
+bool TilesetPreview::loaded() const {
+	return _rom != nullptr;
+}
+
+void TilesetPreview::findSamples() {
+	// The first room we find for each tileset is the one that gets shown
+	const wxByte *rom = _rom->_dataBuffer;
+	for (uint64_t p = kAddrRoomsStart; (p + kRoomHeaderSize) < kAddrRoomsEnd; p++) {
+		uint64_t states[kRoomMaxStates];
+		int numStates = readRoomStates(rom, p, states);
+		if (numStates == 0) {
+			continue;
+		}
+
+		// Without the FX1 lists to check against, the tileset and level data are what tell us this really is a room
+		bool valid = true;
+		for (int s = 0; (s < numStates) && (valid == true); s++) {
+			uint32_t levelData = readLong(rom, states[s] + kRoomStateLevelData);
+			if (((states[s] + kRoomStateSize) > kAddrRoomsEnd) || (rom[states[s] + kRoomStateTileset] >= kNumTilesets) || (levelData < 0x808000) || (Rom::snesToPc(levelData) >= _rom->_length)) {
+				valid = false;
+			}
+		}
+		if (valid == false) {
+			continue;
+		}
+
+		uint64_t state = states[numStates - 1];
+		Sample &sample = _samples[rom[state + kRoomStateTileset]];
+		if (sample.state == 0) {
+			sample.state = state;
+			sample.width = rom[p + 4];
+			sample.height = rom[p + 5];
+		}
+		p = state + kRoomStateSize - 1;
+	}
+}
+
+void TilesetPreview::basePalette(int tileset, Rgb *palette) {
+	uint32_t address = readLong(_rom->_dataBuffer, kAddrTilesets + (tileset * kTilesetEntrySize) + 6);
+	_rom->decompressPalette(palette, Rom::snesToPc(address));
+}
+
+bool TilesetPreview::decode(int tileset) {
+	const Sample &sample = _samples[tileset];
+	Decoded &decoded = _decoded[tileset];
+	decoded.done = true;
+	if (sample.state == 0) {
+		return false;
+	}
+
+	const wxByte *rom = _rom->_dataBuffer;
+	uint64_t entry = kAddrTilesets + (tileset * kTilesetEntrySize);
+	bool cre = (tileset < kCeresFirst) || (tileset > kCeresLast);
+
+	// The blocks start with the CRE ones (if there are any) and then the tileset's own
+	std::vector<uint8_t> blocks;
+	if (cre == true) {
+		_rom->decompress(kAddrCRETable, blocks);
+		blocks.resize(kCREBlocks * kBlockBytes);
+	}
+
+	std::vector<uint8_t> buffer;
+	if (_rom->decompress(Rom::snesToPc(readLong(rom, entry)), buffer) == false) {
+		return false;
+	}
+	blocks.insert(blocks.end(), buffer.begin(), buffer.end());
+
+	// The gfx go into vram the same way, the tileset's at the start and the CRE after
+	std::vector<uint8_t> vram(kVramTiles * kTileBytes, 0);
+	if (_rom->decompress(Rom::snesToPc(readLong(rom, entry + 3)), buffer) == false) {
+		return false;
+	}
+	std::copy(buffer.begin(), buffer.begin() + std::min(buffer.size(), vram.size()), vram.begin());
+
+	if ((cre == true) && (_rom->decompress(kAddrCREGfx, buffer) == true)) {
+		size_t start = kCRETileStart * kTileBytes;
+		std::copy(buffer.begin(), buffer.begin() + std::min(buffer.size(), vram.size() - start), vram.begin() + start);
+	}
+
+	// Every 4bpp tile gets turned into plain colour numbers (0-15)
+	std::vector<uint8_t> tiles(kVramTiles * kTilePixels);
+	for (int t = 0; t < kVramTiles; t++) {
+		const uint8_t *tile = &vram[t * kTileBytes];
+		for (int y = 0; y < 8; y++) {
+			for (int x = 0; x < 8; x++) {
+				int bit = 7 - x;
+				tiles[(t * kTilePixels) + (y * 8) + x] = ((tile[y * 2] >> bit) & 1) | (((tile[(y * 2) + 1] >> bit) & 1) << 1)
+													   | (((tile[(y * 2) + 16] >> bit) & 1) << 2) | (((tile[(y * 2) + 17] >> bit) & 1) << 3);
+			}
+		}
+	}
+
+	// Level data starts with the size of layer 1, and then layer 1 itself, one word per block
+	std::vector<uint8_t> level;
+	if (_rom->decompress(Rom::snesToPc(readLong(rom, sample.state + kRoomStateLevelData)), level) == false) {
+		return false;
+	}
+
+	int roomBlocks = sample.width * (kScreenPixels / kBlockPixels);
+	int screensX = std::min<int>(sample.width, kPreviewMaxScreens);
+	int screensY = std::min<int>(sample.height, kPreviewMaxScreens);
+	decoded.width = screensX * kScreenPixels;
+	decoded.height = screensY * kScreenPixels;
+	decoded.pixels.assign(decoded.width * decoded.height, 0);
+
+	for (int by = 0; by < decoded.height / kBlockPixels; by++) {
+		for (int bx = 0; bx < decoded.width / kBlockPixels; bx++) {
+			size_t index = 2 + (((by * roomBlocks) + bx) * 2);
+			if ((index + 1) >= level.size()) {
+				continue;
+			}
+
+			uint16_t block = level[index] | (level[index + 1] << 8);
+			size_t definition = (block & 0x3FF) * kBlockBytes;
+			if ((definition + kBlockBytes) > blocks.size()) {
+				continue;
+			}
+
+			// Each of the 4 tiles of the block has its own palette line and flips, on top of the block's flips
+			for (int q = 0; q < 4; q++) {
+				uint16_t tile = blocks[definition + (q * 2)] | (blocks[definition + (q * 2) + 1] << 8);
+				int line = (tile >> 10) & 7;
+				bool flipX = ((tile & 0x4000) != 0) != ((block & 0x400) != 0);
+				bool flipY = ((tile & 0x8000) != 0) != ((block & 0x800) != 0);
+				int qx = (q & 1) ^ (((block & 0x400) != 0) ? 1 : 0);
+				int qy = (q >> 1) ^ (((block & 0x800) != 0) ? 1 : 0);
+
+				const uint8_t *pixels = &tiles[(tile & 0x3FF) * kTilePixels];
+				for (int y = 0; y < 8; y++) {
+					uint8_t *row = &decoded.pixels[(((by * kBlockPixels) + (qy * 8) + y) * decoded.width) + (bx * kBlockPixels) + (qx * 8)];
+					for (int x = 0; x < 8; x++) {
+						uint8_t colour = pixels[((flipY == true) ? (7 - y) : y) * 8 + ((flipX == true) ? (7 - x) : x)];
+
+						// Colour 0 of any line is see through, which leaves the backdrop (colour 0 of the palette)
+						row[x] = (colour == 0) ? 0 : (line * 16) + colour;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool TilesetPreview::render(int tileset, const Rgb *palette, wxImage &image) {
+	if ((loaded() == false) || (tileset < 0) || (tileset >= kNumTilesets)) {
+		return false;
+	}
+
+	// Decoding only happens once per tileset, after that it's just the colours
+	if (_decoded[tileset].done == false) {
+		decode(tileset);
+	}
+
+	const Decoded &decoded = _decoded[tileset];
+	if (decoded.pixels.size() == 0) {
+		return false;
+	}
+
+	image.Create(decoded.width, decoded.height, false);
+	unsigned char *data = image.GetData();
+	for (size_t i = 0; i < decoded.pixels.size(); i++) {
+		const Rgb &colour = palette[decoded.pixels[i]];
+		data[(i * 3)] = colour.r;
+		data[(i * 3) + 1] = colour.g;
+		data[(i * 3) + 2] = colour.b;
+	}
+	return true;
+}
+
+PreviewPanel::PreviewPanel(wxWindow *parent) : wxPanel(parent, wxID_ANY, wxDefaultPosition, wxSize(kScreenPixels, kScreenPixels), wxFULL_REPAINT_ON_RESIZE) {
+	SetBackgroundStyle(wxBG_STYLE_PAINT);
+	Bind(wxEVT_PAINT, &PreviewPanel::onPaint, this);
+	Bind(wxEVT_SIZE, &PreviewPanel::onSize, this);
+}
+
+void PreviewPanel::setImage(const wxImage &image) {
+	_bitmap = wxBitmap(image);
+	Refresh(false);
+}
+
+void PreviewPanel::onPaint(wxPaintEvent &event) {
+	wxPaintDC dc(this);
+	dc.SetBackground(*wxBLACK_BRUSH);
+	dc.Clear();
+
+	if (_bitmap.IsOk() == false) {
+		return;
+	}
+
+	// The room is scaled to fit the panel, keeping its shape
+	wxSize size = GetClientSize();
+	double scale = std::min((double) size.GetWidth() / _bitmap.GetWidth(), (double) size.GetHeight() / _bitmap.GetHeight());
+	if (scale <= 0) {
+		return;
+	}
+	dc.SetUserScale(scale, scale);
+	dc.DrawBitmap(_bitmap, 0, 0);
+}
+
+void PreviewPanel::onSize(wxSizeEvent &event) {
+	Refresh(false);
+	event.Skip();
+}
@@ -0,0 +1,91 @@
+#ifndef RANDO_PREVIEW_H
+#define RANDO_PREVIEW_H
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include <wx/wxprec.h>
+
+#ifndef WX_PRECOMP
+	#include <wx/wx.h>
+#endif
+
+#include <vector>
+
+#include "rom.h"
+#include "colour.h"
+
+enum PreviewValues {
+	kAddrTilesets		= 0x7E6A2,	// The tileset table, each one a long pointer to the tile table, the gfx and the palette
+	kTilesetEntrySize	= 9,
+	kAddrCREGfx			= 0x1C8000,	// The common room elements, which every tileset outside of ceres loads after its own
+	kAddrCRETable		= 0x1CA09D,
+	kCRETileStart		= 0x280,	// Where the CRE gfx start in vram, in 8x8 tiles
+	kCREBlocks			= 0x100,	// And how many of the 16x16 blocks are CRE ones
+	kCeresFirst			= 15,		// The ceres tilesets don't use CRE
+	kCeresLast			= 20,
+	kTileBytes			= 32,		// A 4bpp 8x8 tile
+	kTilePixels			= 64,
+	kVramTiles			= 0x400,
+	kBlockBytes			= 8,		// A 16x16 block is 4 tiles
+	kBlockPixels		= 16,
+	kScreenPixels		= 256,
+	kPreviewMaxScreens	= 4			// Anything bigger than this only has its top left corner shown
+};
+
+/* Tileset Preview
+ * Draws a room that uses a given tileset, straight from
+ * the graphics in the base rom, with whatever palette
+ * it's given. The room only gets decoded the first time,
+ * after that a new palette is just a recolour.
+ */
+class TilesetPreview {
+public:
+	~TilesetPreview() {
+		delete _rom;
+	}
+
+	void load(wxString path);										// Loads a copy of the base rom and finds a room for each tileset
+	bool loaded() const;
+	void basePalette(int tileset, Rgb *palette);					// Gets the palette the tileset has in the base rom
+	bool render(int tileset, const Rgb *palette, wxImage &image);	// Draws the tileset's room with palette, returning false if there isn't one
+
+private:
+	// The room we show for a tileset
+	struct Sample {
+		uint64_t state = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+	// And that room drawn out as palette indexes
+	struct Decoded {
+		bool done = false;
+		int width = 0;
+		int height = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	Rom *_rom = nullptr;
+	std::vector<Sample> _samples;
+	std::vector<Decoded> _decoded;
+
+	void findSamples();
+	bool decode(int tileset);
+};
+
+/* Preview Panel
+ * Just shows a bitmap, scaled to fit the panel
+ */
+class PreviewPanel : public wxPanel {
+public:
+	PreviewPanel(wxWindow *parent);
+
+	void setImage(const wxImage &image);
+
+private:
+	wxBitmap _bitmap;
+
+	void onPaint(wxPaintEvent &event);
+	void onSize(wxSizeEvent &event);
+};
+
+#endif
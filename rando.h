@@ -15,7 +15,10 @@
 #include <bitset>
 #include <stack>
 #include <unordered_set>
+#include <unordered_map>
 #include <functional>
+#include <thread>
+#include <atomic>
 
 #include <wx/notebook.h>
 #include "wx/colordlg.h"
@@ -49,182 +52,11 @@
 #include "wx/renderer.h"
 #include "wx/uilocale.h"
 #include <wx/spinctrl.h>
+#include <wx/gauge.h>
 #include <wx/statline.h>
 
-#include "rom.h"
-
-struct Node;
-struct Location;
-
-enum StorageType {
-	kNormal,
-	kChozo,
-	kHidden
-};
-
-enum Major {
-	kMinor,
-	kMajor
-};
-
-struct Item {
-	wxString name;
-	uint16_t value;
-	int weight;
-	int number;
-	Major major = kMajor;
-	Item() {}
-	Item(wxString n, uint16_t v, int w) {
-		name = n;
-		value = v;
-		weight = w;
-		number = 1;
-	}
-};
-
-struct Player {
-	uint64_t collected 	 = 0;
-	bool majorMinor  = false;
-	int energyLow 	 = 0;
-	int energyMed 	 = 0;
-	int energyHigh 	 = 0;
-	int missilesLow  = 0;
-	int missilesMed  = 0;
-	int missilesHigh = 0;
-};
-
-enum ObjectType {
-	kObjNone,
-	kObjNatural,
-	kObjMetal,
-	kObjStone,
-	kObjGlass,
-	kObjWater
-};
-
-enum Relationship {
-	kRelNone,
-	kRelCompliment,
-	kRelAnalogous,
-	kRelTriadic,
-	kRelTetradic
-};
-
-struct PalColour {
-	int index = 0;
-	ObjectType object = kObjNone;
-	Relationship relation = kRelNone;
-	int reference = -1;
-	float saturation = 1;
-	int gradient = 0;
-	int brightnessS = 100;
-	int brightnessE = -1;
-	float hueShift = 0;
-	bool background = false;
-	int tileset = -1;
-	const wxColour *hardCoded = nullptr;
-
-	PalColour(int i, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE, float shift, int tile) {
-		index = i;
-		object = obj;
-		relation = rel;
-		reference = ref;
-		saturation = sat;
-		gradient = grad;
-		brightnessS = bS;
-		brightnessE = bE;
-		hueShift = shift;
-		tileset = tile;
-	}
-
-	PalColour(int i, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE, float shift) {
-		index = i;
-		object = obj;
-		relation = rel;
-		reference = ref;
-		saturation = sat;
-		gradient = grad;
-		brightnessS = bS;
-		brightnessE = bE;
-		hueShift = shift;
-	}
-
-
-	PalColour(int i, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE) {
-		index = i;
-		object = obj;
-		relation = rel;
-		reference = ref;
-		saturation = sat;
-		gradient = grad;
-		brightnessS = bS;
-		brightnessE = bE;
-	}
-
-	PalColour(int i, bool bg, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE) {
-		index = i;
-		object = obj;
-		relation = rel;
-		reference = ref;
-		saturation = sat;
-		gradient = grad;
-		brightnessS = bS;
-		brightnessE = bE;
-		background = bg;
-	}
-
-	PalColour(int i, bool bg, ObjectType obj, Relationship rel, int ref, float sat, int grad, int bS, int bE, float shift) {
-		index = i;
-		object = obj;
-		relation = rel;
-		reference = ref;
-		saturation = sat;
-		gradient = grad;
-		brightnessS = bS;
-		brightnessE = bE;
-		background = bg;
-		hueShift = shift;
-	}
-
-	PalColour(int i, int ref, int bS) {
-		index = i;
-		reference = ref;
-		brightnessS = bS;
-	}
-
-	PalColour(int i, int ref, int grad, int bS, int bE) {
-		index = i;
-		reference = ref;
-		gradient = grad;
-		brightnessS = bS;
-		brightnessE = bE;
-	}
-
-	PalColour(int i, int ref, int grad, int bS, int bE, float shift) {
-		index = i;
-		reference = ref;
-		gradient = grad;
-		brightnessS = bS;
-		brightnessE = bE;
-		hueShift = shift;
-	}
-
-	PalColour(int i, const wxColour *hard) {
-		index = i;
-		hardCoded = hard;
-	}
-
-	PalColour(int i, wxColour hard, int grad, int bS, int bE) {
-		index = i;
-		gradient = grad;
-		brightnessS = bS;
-		brightnessE = bE;
-		hardCoded = &hard;
-	}
-};
-
-// We're going to need a dictionary for the items
-WX_DECLARE_HASH_MAP(uint64_t, Item, wxIntegerHash, wxIntegerEqual, ItemDict);
+#include "generator.h"
+#include "preview.h"
 
 /* wxWidgets related enums and structs
  */
@@ -232,22 +64,6 @@ enum CommonValues {
 	kMacMargins = 19,
 };
 
-enum Address {
-	kAddrItems    = 0xF0AC,
-	kAddrOptions1 = 0xF0E2,
-	kAddrOptions2 = 0xF0E9,
-	kAddrPause    = 0xF0F0,
-	kAddrHud      = 0xF0F7,
-	kAddrBombTime = 0xF0FE,
-	kAddrButtons  = 0x0000,
-	kAddrGfxPal   = 0x7E6A8,
-	kAddrEnemyPal = 0x104EC1,
-	kAddrBeamPal  = 0x8763A,
-	kAddrSuits	  = 0x20717,
-	kAddrSpore    = 0x78642,
-	kAddrHeat	  = 0x6E37D
-};
-
 enum ID {
 	// You can not add a menu ID of 0 on macOS (it's reserved for 'help' I think?)
 	ID_Default,
@@ -262,9 +78,34 @@ enum ID {
 	ID_MenuPreferences,
 	ID_MenuCredits,
 	ID_MenuContact,
+	ID_MenuExportTrace,
 
 	// Toolbar	
-	ID_ToolOpen
+	ID_ToolOpen,
+
+	// Worker thread events
+	ID_RandoProgress,
+	ID_RandoDone
+};
+
+/* Palette Table
+ * The data behind the palette grid. It keeps the colours
+ * themselves, so the renderer can draw them straight
+ * from here instead of going through the cell text
+ */
+class PaletteTable : public wxGridTableBase {
+public:
+	void setColours(const Rgb *colours);				// Copies in a whole palette (8 rows of 16)
+	const Rgb &getColour(int row, int col) const;
+
+	virtual int GetNumberRows() wxOVERRIDE { return kPaletteRows; }
+	virtual int GetNumberCols() wxOVERRIDE { return kPaletteRowColours; }
+	virtual bool IsEmptyCell(int row, int col) wxOVERRIDE { return false; }
+	virtual wxString GetValue(int row, int col) wxOVERRIDE;
+	virtual void SetValue(int row, int col, const wxString &value) wxOVERRIDE {}
+
+private:
+	Rgb _colours[kPaletteColours] = {};
 };
 
 /* Rando Application
@@ -282,24 +123,19 @@ public:
  * This class is the frame within which all
  * panels and controls get placed
  */
-class RandoFrame : public wxFrame {
+class RandoFrame : public wxFrame, public Generator {
 public:
 	RandoFrame(wxSize s);
 
 protected:
-	// The rom is a member so that it can be read/written from anywhere
-	Rom *_rom = nullptr;
-
-	// The log also needs to be written to from anywhere
-	wxString _log = "";
-
-	// This object represents the player. It needs to be outside of the logic so that tricks can be applied to it
-	Player _player;
-
 	wxString _basePath = "";
 	wxString _outputPath = "";
 	long _seed = 0;
 
+	// Generation runs on its own thread, working only from the settings taken when randomize was pressed
+	std::thread _worker;
+	bool _running = false;
+
 	// The 'options' are bitflags in project base that are controlled by a set of event bits in the code base
 	// They default to the default's in project base
 	uint16_t _options1 = 0xFDF9;
@@ -330,8 +166,15 @@ protected:
 	// And all the components we need to be able to reference within logic
 	wxCheckBox *_romType;
 
-	wxColour _examplePalette[256];
 	wxGrid *_paletteGrid;
+	PaletteTable *_paletteTable;
+
+	// The tileset preview has its own copy of the base rom, and its own palettes to show
+	TilesetPreview _preview;
+	Palette128 _previewPalettes[kNumTilesets];
+	Rng _previewRng = Rng(time(0));
+	PreviewPanel *_previewPanel;
+	    wxChoice *_previewTileset;
 
 	  wxChoice *_hud;
 	  wxChoice *_pauseDefault;
@@ -347,6 +190,7 @@ protected:
 	wxCheckBox *_shuffleEnemyPal;
 	wxCheckBox *_shuffleBeamPal;
 	wxCheckBox *_shuffleSuitPal;
+	wxCheckBox *_generateSuitPal;
 	wxCheckBox *_includePBExpanded;
 	wxCheckBox *_includeHacks;
 	wxCheckBox *_includeVanilla;
@@ -370,80 +214,9 @@ protected:
 	wxTextCtrl *_seedCtrl;
 	wxTextCtrl *_outputCtrl;
 	wxTextCtrl *_logCtrl;
-
-	// Lastly we have the patches and palettes
-	// These are the palettes for the suits that get randomly applied
-	int _paletteSizes[8] = {0x20, 0x20 * 8, 0x20 * 4, 0x20 * 4, 0x20 * 4, 0x20 * 4, 0x20, 0x220};
-	int _paletteAddrPower[8]   = {0xD9400, 0xD9820, 0xD9B20, 0xD9BA0, 0xD9C20, 0xD9CA0, 0x6DC09, 0x6E466};
-	int _paletteAddrVaria[8]   = {0xD9520, 0xD9920, 0xD9D20, 0xD9DA0, 0xD9E20, 0xD9EA0, 0x6DD6F, 0x6E692};
-	int _paletteAddrGravity[8] = {0xD9800, 0xD9A20, 0xD9F20, 0xD9FA0, 0xDA020, 0xDA0A0, 0x6DED5, 0x6E8BE};
-
-	// Vanilla palettes
-	wxByte **_palettePower;
-	wxByte **_paletteVaria;
-	wxByte **_paletteGravity;
-
-	// PB Extended palettes
-	wxByte **_paletteSlate;
-	wxByte **_paletteWhite;
-	wxByte **_paletteGreen;
-	wxByte **_paletteGrime;
-	wxByte **_palettePhazon;
-	wxByte **_paletteFusion;
-
-	// Hack palettes
-	wxByte **_palettePhazonP;
-	wxByte **_palettePhazonV;
-	wxByte **_palettePhazonG;
-	wxByte **_paletteHallowEve;
-	wxByte **_paletteFinalStandP;
-	wxByte **_paletteFinalStandV;
-	wxByte **_paletteFinalStandG;
-	wxByte **_paletteHangTimeP;
-	wxByte **_paletteHangTimeG;
-	wxByte **_paletteLostWorldP;
-	wxByte **_paletteLostWorldG;
-	wxByte **_paletteVanillaPlus;
-	wxByte **_paletteHyperP;
-	wxByte **_paletteHyperV;
-	wxByte **_paletteHyperG;
-	wxByte **_paletteIceMetalP;
-	wxByte **_paletteIceMetalV;
-	wxByte **_paletteIceMetalG;
-
-	// These are the patches needed for the rom, in the form of byte buffers
-	wxByte *_patchEvents;
-	wxByte *_patchSkipCeres;
-	wxByte *_patchEffects;
-
-	// These are patches needed for fixing things in the vanilla map version of PB
-	wxByte *_patchDashBall;
-
-	// These are also patches, but specifically for gfx data
-	wxByte *_gfxFontBrail;
-	wxByte *_gfxFontUpsideDown;
-	wxByte *_gfxFontGalactic;
-	wxByte *_gfxFontWingDings;
-	wxByte *_gfxFontRuneScape;
-	wxByte *_gfxFontStarWars;
-	wxByte *_gfxFontBadKerning;
-	wxByte *_gfxFontChozo;
-	wxByte *_gfxFontGreek;
-	wxByte *_gfxFontHylian;
-	wxByte *_gfxFontKlingon;
-	wxByte *_gfxFontLeetSpeak;
-	wxByte *_gfxFontLotR;
-	wxByte *_gfxFontMinecraft;
-	wxByte *_gfxFontDots;
-	wxByte *_gfxFontRoman;
-	wxByte *_gfxFontBars;
-	wxByte *_gfxFontAnalogue;
-	wxByte *_gfxFontDice;
-	wxByte *_gfxFontBinary;
-	wxByte *_gfxFontAscii;
-	wxByte *_gfxFontTallies;
-	wxByte *_gfxFontElements;
-	wxByte *_gfxMysteryItem;
+	  wxButton *_randomizeButton;
+	   wxGauge *_progressGauge;
+	wxStaticText *_progressText;
 
 private:
 	// Debug
@@ -452,15 +225,28 @@ private:
 
 	// Menu functions
 	void onOpen(wxCommandEvent& event);
+	void onExportTrace(wxCommandEvent& event);
 	void onRandomize(wxCommandEvent& event);
 	void onPreferences(wxCommandEvent& event);
 	void onContact(wxCommandEvent& event);
 	void onCredits(wxCommandEvent& event);
 	void onExit(wxCommandEvent& event);
 	void onAbout(wxCommandEvent& event);
+	void onClose(wxCloseEvent& event);
+
+	// Worker functions
+	RandoSettings takeSettings();
+	void generate();
+	void progress(int percent, wxString phase) wxOVERRIDE;
+	void onRandoProgress(wxThreadEvent& event);
+	void onRandoDone(wxThreadEvent& event);
+	void showExamplePalette();
+	void reportAllocations();			// Only does anything when built with TRACK_ALLOCS=1
+	void refreshPreview();
+	void onPreviewTileset(wxCommandEvent& event);
+	void onPreviewReroll(wxCommandEvent& event);
 
 	// Init functions
-	void initializePatches();
 	void populateMenuBar(wxMenuBar *menuBar);
 	void populateToolBar(wxToolBar *toolBar);
 	void populateMainPanel();
@@ -471,29 +257,8 @@ private:
 	void onTechniqueGridLeftClick(wxGridEvent& event);
 	void onBrowse(wxCommandEvent& event);
 
-	// Other feature functions
-	void makeNewTilesetPalettes();
-	void shuffleTilesetPalettes();
-	void fixHeatPalettes(wxColour *tilesets[29]);
-	void fixGlowPalettes(wxColour *tilesets[29]);
-	void processTilesetTemplate(wxColour *tilesets[29], wxVector<PalColour *> templates[29], int t);
-	void writeLockedPaletteColours(wxColour *tilesets[29]);
-	void shuffleEnemyPalettes();
-	void shuffleBeamPalettes();
-	void shuffleSuitPalettes();
-	void shuffleFontText();
-	void shuffleFontNumbers();
-	void shuffleFX1();
-	void floodFX1();
-
 	// Seed functions
 	void getSeed();
-
-	// Logic functions
-	void logic();
-	bool checkRequirements(Node *node, ItemDict itemPool);
-	void setItem(wxVector<Location> &locations, int pos, uint64_t item, ItemDict &itemPool, int &allWeights);
-	void resetLocationsAndItems(wxVector<Location> &locations, wxVector<Location> &locationsMinor, ItemDict &itemPool, int &allWeights);
 };
 
 class PaletteRenderer : public wxGridCellStringRenderer {
@@ -503,5 +268,4 @@ public:
 
 DECLARE_APP(Rando)
 
-#endif
-
+#endif
\ No newline at end of file
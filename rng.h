@@ -0,0 +1,76 @@
+#ifndef RANDO_RNG_H
+#define RANDO_RNG_H
+
+#include <cstdint>
+#include <utility>
+
+/* Random numbers
+ * A small generator (xoshiro256**) that can be split into independent streams.
+ * Anything that might run on another thread, or in a different order, gets its
+ * own stream derived from a seed and a number for that part, so what it draws
+ * never depends on what anything else drew first.
+ */
+class Rng {
+public:
+	explicit Rng(uint64_t seed) : _seed(seed) {
+		// Splitmix fills out the state, so even seeds like 0 and 1 start nowhere near each other
+		uint64_t x = seed;
+		for (int i = 0; i < 4; i++) {
+			_state[i] = splitmix(x);
+		}
+	}
+
+	uint64_t next() {
+		uint64_t result = rotl(_state[1] * 5, 7) * 9;
+		uint64_t t = _state[1] << 17;
+		_state[2] ^= _state[0];
+		_state[3] ^= _state[1];
+		_state[1] ^= _state[2];
+		_state[0] ^= _state[3];
+		_state[2] ^= t;
+		_state[3] = rotl(_state[3], 45);
+		return result;
+	}
+
+	// A number from 0 to n - 1 (using the top bits, which are the best ones)
+	uint32_t below(uint32_t n) {
+		return (uint32_t) (((next() >> 32) * n) >> 32);
+	}
+
+	// Puts everything from first up to last in a random order (Fisher-Yates)
+	template <typename Iterator>
+	void shuffle(Iterator first, Iterator last) {
+		for (uint32_t i = last - first; i > 1; i--) {
+			std::swap(first[i - 1], first[below(i)]);
+		}
+	}
+
+	// A new generator for a numbered sub-stream, which only depends on this one's seed, not on how much of it has been used.
+	// The seed gets mixed before the stream is added, so derive(a).derive(b) and derive(b).derive(a) (or derive(a) twice) never land on the same seed
+	Rng derive(uint64_t stream) const {
+		uint64_t x = _seed;
+		uint64_t y = splitmix(x) + stream;
+		return Rng(splitmix(y));
+	}
+
+	uint64_t seed() const {
+		return _seed;
+	}
+
+private:
+	uint64_t _seed;
+	uint64_t _state[4];
+
+	static uint64_t rotl(uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+	static uint64_t splitmix(uint64_t &x) {
+		uint64_t z = (x += 0x9E3779B97F4A7C15);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+		return z ^ (z >> 31);
+	}
+};
+
+#endif
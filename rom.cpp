@@ -1,13 +1,37 @@
 #include "rom.h"
+#include "colour.h"
+#include "parallel.h"
+#include "trace.h"
+
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
 
 Rom::Rom(wxString path) {
-	// Make a new file object for the base rom
-	_rom = new wxFile(path, wxFile::read_write);
+	TRACE_SCOPE("load rom");
+
+	// Make a new file object for the base rom (nothing ever writes to it, seeds go to a new file)
+	_rom = new wxFile(path, wxFile::read);
 	
 	// If the file is opened (ie. the path was valid), then we make a new data buffer and give it the file contents
-	if (_rom->IsOpened()) {
-		_dataBuffer = (wxByte *)malloc(_rom->Length());
-		_rom->Read(_dataBuffer, _rom->Length());
+	if ((_rom->IsOpened() == true) && (_rom->Length() > 0)) {
+		_length = _rom->Length();
+		_dataBuffer = (wxByte *)malloc(_length);
+
+		// A short read means the file changed while we were reading it, which is no better than not opening it
+		if (_rom->Read(_dataBuffer, _length) != (ssize_t) _length) {
+			wxLogError("File could not be read!");
+			free(_dataBuffer);
+			_dataBuffer = nullptr;
+			_length = 0;
+			return;
+		}
+
+		// We also keep it as it was, so each seed can start from a clean copy without reading the file again
+		wxByte *original = (wxByte *)malloc(_length);
+		memcpy(original, _dataBuffer, _length);
+		_original.reset(original, free);
 
 	// Otherwise just give a message and end
 	} else {
@@ -18,54 +42,119 @@ Rom::Rom(wxString path) {
 	// The name can be found from the fileName object with a given path
 	wxFileName name(path);
 	_name = name.GetName();
+	_path = path;
+}
+
+Rom::Rom(const Rom &base) {
+	TRACE_SCOPE("copy rom");
+
+	// The file is never read again, so a copy doesn't need one. Everything it needs to know is from when the base was loaded
+	_rom = nullptr;
+	_name = base._name;
+	_path = base._path;
+	_original = base._original;
+	_length = base._length;
+
+	if (base.isLoaded() == true) {
+		_dataBuffer = (wxByte *)malloc(_length);
+		memcpy(_dataBuffer, _original.get(), _length);
+	}
+}
+
+bool Rom::isLoaded() const {
+	return _original != nullptr;
 }
 
 void Rom::makeNewRom(wxString fileName) {
-	// Create a new file object that will be used for making the rom
-	wxFile *output = new wxFile();
+	TRACE_SCOPE("write rom");
+
+	// Create a new file object that will be used for making the rom (which closes it when it goes out of scope)
+	wxFile output;
 
 	// Create the actual rom file with the filename given
-	output->Create(fileName, true);
+	output.Create(fileName, true);
 
 	// Start at the beginning of the file, and write the data buffer to the new rom
-	output->Seek(0);
-	output->Write(_dataBuffer, _rom->Length());
+	output.Seek(0);
+	output.Write(_dataBuffer, _length);
+}
+
+void Rom::revert() {
+	if (isLoaded() == false) {
+		return;
+	}
+	memcpy(_dataBuffer, _original.get(), _length);
+}
+
+void Rom::replay(const std::vector<RomWrite> &writes) {
+	for (const RomWrite &write : writes) {
+		setBytes(write.offset, write.bytes.data(), write.bytes.size());
+	}
+}
+
+void Rom::journal(uint64_t offset, size_t length) {
+	if (_journal == nullptr) {
+		return;
+	}
+
+	// Writes that carry on from the last one just get added onto it
+	if ((_journal->size() > 0) && ((_journal->back().offset + _journal->back().bytes.size()) == offset)) {
+		_journal->back().bytes.insert(_journal->back().bytes.end(), _dataBuffer + offset, _dataBuffer + offset + length);
+
+	} else {
+		_journal->push_back({offset, std::vector<wxByte>(_dataBuffer + offset, _dataBuffer + offset + length)});
+	}
 }
 
 wxByte Rom::getByte(uint64_t offset) {
-	if (offset < _rom->Length()) {
+	if (offset < _length) {
 		return _dataBuffer[offset];
 
 	} else {
-		std::cout << "invalid offset! Can't access offset, returning 0xFF instead " << offset << std::endl;
+		TRACE_LOG(kLogError, "invalid offset! Can't access offset, returning 0xFF instead " << offset);
 		return 0xFF;
 	}
 }
 
 void Rom::setByte(uint64_t offset, wxByte byte) {
-	if (offset >= _rom->Length()) {
-		std::cout << "invalid offset! Can't access offset " << offset << std::endl;
+	if (offset >= _length) {
+		TRACE_LOG(kLogError, "invalid offset! Can't access offset " << offset);
 		return;
 	}
 
 	// Set the byte at the offset in the data buffer to the given byte
 	_dataBuffer[offset] = byte;
+	journal(offset, 1);
 }
 
 void Rom::setWord(uint64_t offset, uint16_t word) {
-	if (offset >= _rom->Length()) {
-		std::cout << "invalid offset! Can't access offset " << offset << std::endl;
+	if (offset >= _length) {
+		TRACE_LOG(kLogError, "invalid offset! Can't access offset " << offset);
 		return;
 	}
 
 	// A word is a uint16, so we take each half and set it to the data buffer
 	_dataBuffer[offset] = word & 0x00FF;
 	_dataBuffer[offset + 1] = (word & 0xFF00) >> 8;
+	journal(offset, 2);
+}
+
+void Rom::setLong(uint64_t offset, uint32_t value) {
+	if ((offset + 2) >= _length) {
+		TRACE_LOG(kLogError, "invalid offset! Can't access offset " << offset);
+		return;
+	}
+
+	// Long pointers are 3 bytes, low byte first and the bank last
+	_dataBuffer[offset] = value & 0x0000FF;
+	_dataBuffer[offset + 1] = (value & 0x00FF00) >> 8;
+	_dataBuffer[offset + 2] = (value & 0xFF0000) >> 16;
+	journal(offset, 3);
 }
 
 void Rom::setBytes(uint64_t offset, wxVector<wxByte> bytes) {
-	if ((offset + bytes.size()) >= _rom->Length()) {
-		std::cout << "invalid offset! Can't access offset and/or number of bytes " << offset << std::endl;
+	if ((offset + bytes.size()) >= _length) {
+		TRACE_LOG(kLogError, "invalid offset! Can't access offset and/or number of bytes " << offset);
 		return;
 	}
 
@@ -73,9 +162,23 @@ void Rom::setBytes(uint64_t offset, wxVector<wxByte> bytes) {
 	for (int i = 0; i < bytes.size(); i++) {
 		_dataBuffer[offset + i] = bytes[i];
 	}
+	journal(offset, bytes.size());
+}
+
+void Rom::setBytes(uint64_t offset, const wxByte *bytes, size_t length) {
+	if ((offset + length) >= _length) {
+		TRACE_LOG(kLogError, "invalid offset! Can't access offset and/or number of bytes " << offset);
+		return;
+	}
+
+	// With a plain buffer we can copy the whole thing at once
+	memcpy(_dataBuffer + offset, bytes, length);
+	journal(offset, length);
 }
 
 void Rom::applyPatch(wxByte *patch) {
+	TRACE_SCOPE("applyPatch");
+
 	if ((patch[0] == 'P') && (patch[1] == 'A') && (patch[2] == 'T') && (patch[3] == 'C') && (patch[4] == 'H')) {
 		uint64_t index = 5;
 		while (!((patch[index] == 'E') && (patch[index + 1] == 'O') && (patch[index + 2] == 'F'))) {
@@ -101,437 +204,301 @@ void Rom::applyPatch(wxByte *patch) {
 		}
 
 	} else {
-		std::cout << "not a patch" << std::endl;
+		TRACE_LOG(kLogError, "not a patch");
 		return;
 	}
 }
 
-void Rom::storeColour(uint64_t addr, wxColour clr) {
-	// Convert the colour to 15bit
-	int newR = trunc(float(clr.Red())   / float((1 << 8) - 1) * float((1 << 5) - 1) + 0.5f);
-	int newG = trunc(float(clr.Green()) / float((1 << 8) - 1) * float((1 << 5) - 1) + 0.5f);
-	int newB = trunc(float(clr.Blue())  / float((1 << 8) - 1) * float((1 << 5) - 1) + 0.5f);
-
-	// Now we need to store the new colours into the palette buffer by compressing them into a single 15bit value across 2 bytes
-	_dataBuffer[addr] = newR | (newG << 5);
-	_dataBuffer[addr + 1] = (newG >> 3) | newB << 2;
+std::vector<wxByte> Rom::makePatch() {
+	TRACE_SCOPE("makePatch");
+	return diff(_original.get(), _dataBuffer, _length);
 }
 
-/* This compression code is converted to c++ from https://github.com/DJuttmann/SM3E/blob/master/SM3E/Tools/Compression.cs
- * thank you so much DJuttmann! */
-enum paletteSizes {
-	kPalSize = 128,
-	kPalBytes = 256
-};
+std::vector<wxByte> Rom::diff(const wxByte *from, const wxByte *to, uint64_t length) {
+	std::vector<wxByte> patch = {'P', 'A', 'T', 'C', 'H'};
+	length = std::min<uint64_t>(length, kIPSMaxOffset + 1);
 
-void Rom::decompressPalette(wxColour *palette, uint64_t offset) {
-	int startPos = offset;
-	wxByte copyByte1;
-	wxByte copyByte2;
-	int address;
-	bool longLength;
-	wxVector<wxByte> output;
-
-	while (offset < (startPos + 0x8000)) {
-		wxByte currentByte = getByte(offset);
-		offset++;
-		int command = currentByte >> 5;
-		int length = (currentByte & 0b11111) + 1;
-		
-		if (currentByte == 0xFF) {
-			offset = startPos + 0x8000; // tell the loop to end, we've reached the end of the compressed data
-		
-		} else {
-			do {
-				longLength = false;
-				switch (command) {
-					case 0b000:
-						for (int i = 0; i < length; i++) {
-							output.push_back(getByte(offset + i));
-						}
-						offset += length;
-						break;
-					case 0b001:
-						copyByte1 = getByte(offset);
-						offset++;
-						for (int i = 0; i < length; i++) {
-							output.push_back(copyByte1);
-						}
-						break;
-					case 0b010:
-						copyByte1 = getByte(offset);
-						copyByte2 = getByte(offset + 1);
-						offset += 2;
-						for (int i = 0; i < length; i++) {
-							output.push_back((i % 2) == 0 ? copyByte1 : copyByte2); 
-						}
-						break;
-					case 0b011:
-						copyByte1 = getByte(offset);
-						offset++;
-						for (int i = 0; i < length; i++) {
-							output.push_back(copyByte1++);
-						}
-						break;
-					case 0b100:
-						address = getByte(offset) + (getByte(offset + 1) << 8);
-						if (address >= output.size()) {
-							std::cout << "address not within output range!" << std::endl;
-							return;
-						}
-						offset += 2;
-						for (int i = 0; i < length; i++) {
-							output.push_back(output[address + i]);
-						}
-						break;
-					case 0b101:	// same as 0b100 but the bits are flipped
-						address = getByte(offset) + (getByte(offset + 1) << 8);
-						if (address >= output.size()) {
-							std::cout << "address not within output range!" << std::endl;
-							return;
-						}
-						offset += 2;
-						for (int i = 0; i < length; i++) {
-							output.push_back( (wxByte) (output[address + i] ^ 0xFF));
-						}
-						break;
-					case 0b110:
-						address = output.size() - getByte(offset);
-						if (address < 0) {
-							std::cout << "address below 0!" << std::endl;
-							return;
-						}
-						offset++;
-						for (int i = 0; i < length; i++) {
-							output.push_back(output[address + i]);
-						}
-						break;
-					case 0b111:
-						command = (currentByte >> 2) & 0b111;
-						length = ((currentByte & 0b11) << 8) + getByte(offset) + 1;
-						offset++;
-
-						if (command == 0b111) {
-							address = output.size() - getByte(offset);
-							if (address < 0) {
-								std::cout << "address below 0!" << std::endl;
-								return;
-							}
-							offset++;
-							for (int i = 0; i < length; i++) {
-								output.push_back( (wxByte) (output[address + i] ^ 0xFF));
-							}
-
-						} else {
-							longLength = true;
-						}
-						break;
-				}
-			} while (longLength);
+	uint64_t i = 0;
+	while (i < length) {
+		if (from[i] == to[i]) {
+			i++;
+			continue;
 		}
-	}
 
-	std::cout << output.size() << std::endl;
-	
-	for (int i = 0; i < output.size(); i += 2) {
-		int r = output[i] & 0x1F;
-		int g = ((output[i] & 0xE0) >> 5) | ((output[i + 1] & 0x3) << 3);
-		int b = (output[i + 1] & 0x7C) >> 2;
+		// A record can't start at "EOF", so that one starts a byte early instead (rewriting the byte before it is harmless)
+		uint64_t start = (i == kIPSOffsetEOF) ? (i - 1) : i;
 
-		// Convert the colour to 24bit
-		int newR = trunc(float(r)   / float((1 << 5) - 1) * float((1 << 8) - 1) + 0.5f);
-		int newG = trunc(float(g) / float((1 << 5) - 1) * float((1 << 8) - 1) + 0.5f);
-		int newB = trunc(float(b)  / float((1 << 5) - 1) * float((1 << 8) - 1) + 0.5f);
+		// The record carries on over any gap that's shorter than starting a new one would cost
+		uint64_t end = i + 1;
+		uint64_t scan = end;
+		while ((scan < length) && ((scan - start) < kIPSMaxRecord) && ((scan - end) < kIPSHeaderSize)) {
+			if (from[scan] != to[scan]) {
+				end = scan + 1;
+			}
+			scan++;
+		}
 
-		palette[i / 2] = wxColour(newR, newG, newB);
+		uint64_t size = end - start;
+		patch.insert(patch.end(), {(wxByte) (start >> 16), (wxByte) (start >> 8), (wxByte) start, (wxByte) (size >> 8), (wxByte) size});
+		patch.insert(patch.end(), to + start, to + end);
+		i = end;
 	}
 
-	if (output.size() < 256) {
-		int remaining = (256 - output.size()) / 2;
-		for (int i = 128 - remaining; i < 128; i++) {
-			palette[i] = wxColour(0,0,0);
-		}
-	}
+	patch.insert(patch.end(), {'E', 'O', 'F'});
+	return patch;
 }
 
-bool Rom::compressPalette(wxColour *palette, uint64_t offset) {
-	// We start by turning the array of 24bit colours into a byte buffer of 15bit colours
-	wxByte paletteBuffer[kPalBytes];
-	for (int i = 0; i < kPalSize; i++) {
+void Rom::storeColour(uint64_t addr, const Rgb &clr) {
+	// Convert the colour to 15bit, and store it across 2 bytes
+	uint16_t colour = colourTo15(clr);
+	_dataBuffer[addr] = colour & 0x00FF;
+	_dataBuffer[addr + 1] = (colour & 0xFF00) >> 8;
+	journal(addr, 2);
+}
 
-		// Convert the colour to 15bit
-		int newR = trunc(float(palette[i].Red())   / float((1 << 8) - 1) * float((1 << 5) - 1) + 0.5f);
-		int newG = trunc(float(palette[i].Green()) / float((1 << 8) - 1) * float((1 << 5) - 1) + 0.5f);
-		int newB = trunc(float(palette[i].Blue())  / float((1 << 8) - 1) * float((1 << 5) - 1) + 0.5f);
+/* Free space
+ * These are the places we know are safe to put new data into. The first region is where
+ * the game keeps the tileset palettes to begin with, which is all free once we repoint them.
+ * The second is in bank $B8, which is empty in vanilla, but PB only leaves the start of it.
+ */
+static const FreeRegion kFreeSpacePB[] = {
+	{0x212D7C, 0x21417C},
+	{0x1C0000, 0x1C1E00}
+};
 
-		// Now we need to store the new colours into the palette buffer by compressing them into a single 15bit value across 2 bytes
-		paletteBuffer[i * 2] = newR | (newG << 5);
-		paletteBuffer[(i * 2) + 1] = (newG >> 3) | newB << 2;
-	}
+static const FreeRegion kFreeSpaceVanilla[] = {
+	{0x212D7C, 0x21417C},
+	{0x1C0000, 0x1C8000}
+};
 
-	// Next we actually compress the data into an output stream, which we then write into the rom at offset
-	int byteFillLengths[kPalBytes];
-	int wordFillLengths[kPalBytes];
-	int byteIncrementLengths[kPalBytes];
-	Interval copyLengths[kPalBytes];
-	Interval xorCopyLengths[kPalBytes];
-
-	wxVector<wxByte> output;
-
-	int addresses[256][256];
-
-	calcByteFill(byteFillLengths, paletteBuffer);
-	calcWordFill(wordFillLengths, paletteBuffer);
-	calcByteIncrement(byteIncrementLengths, paletteBuffer);
-	calcCopy(copyLengths, paletteBuffer, addresses, wordFillLengths, byteFillLengths);
-
-	int i = 0;
-	while (i < kPalBytes) {
-		auto length = std::max({byteFillLengths[i], wordFillLengths[i], byteIncrementLengths[i], copyLengths[i].Length});
-
-		if (length < 3) {
-			int j = i;
-			while ((j < kPalBytes) && (length < 3)) {
-				length = std::max({byteFillLengths[j], wordFillLengths[j], byteIncrementLengths[j], copyLengths[j].Length});
-				j++;
-			}
-			length = (j == kPalBytes ? j - i : j - i - 1);
-			writeUncompressed(output, i, length, paletteBuffer);
-
-		} else if (length == byteFillLengths[i]) {
-			length = std::min(length, 1024);
-			writeByteFill(output, paletteBuffer[i], length);
-		
-		} else if (length == wordFillLengths[i]) {
-			length = std::min(length, 1024);
-			writeWordFill(output, paletteBuffer[i], paletteBuffer[i + 1], length);
-		
-		} else if (length == byteIncrementLengths[i]) {
-			length = std::min(length, 1024);
-			writeByteIncrement(output, paletteBuffer[i], length);
-		
-		} else if (length == copyLengths[i].Length) {
-			length = std::min(length, 1024);
-			if ((i - copyLengths[i].Address) < 32) {
-				writeNegativeCopy(output, i - copyLengths[i].Address, length);
-			
-			} else {
-				writeCopy(output, copyLengths[i].Address, length);
-			}
-		}
-		i += length;
-	}
-	output.push_back(0xFF);
+void Rom::initFreeSpace(bool vanilla) {
+	_freeSpace.clear();
 
-	if (output.size() < 0x200) {
-		for (int i = 0; i < output.size(); i++) {
-			setByte(offset + i, output[i]);
+	if (vanilla == true) {
+		for (const FreeRegion &region : kFreeSpaceVanilla) {
+			addFreeSpace(region.start, region.end);
 		}
-		return true;
 
 	} else {
-		std::cout << "palette is too large, not overwriting" << std::endl;
-		return false;
+		for (const FreeRegion &region : kFreeSpacePB) {
+			addFreeSpace(region.start, region.end);
+		}
 	}
 }
 
-void Rom::writeChunkHeader(wxVector<wxByte> &output, int type, int length) {
-	length--;
-	if (length < 32) {
-		output.push_back((wxByte) ((type << 5) | length));
-	
-	} else {
-		output.push_back((wxByte) (0b11100000 | (type << 2) | (length >> 8)));
-		output.push_back((wxByte) (length & 0xFF));
+void Rom::revertFreeSpace(bool vanilla) {
+	// Through setBytes, so a stage's journal has the bytes going back too
+	const FreeRegion *regions = (vanilla == true) ? kFreeSpaceVanilla : kFreeSpacePB;
+	int count = (vanilla == true) ? (sizeof(kFreeSpaceVanilla) / sizeof(FreeRegion)) : (sizeof(kFreeSpacePB) / sizeof(FreeRegion));
+	for (int i = 0; i < count; i++) {
+		setBytes(regions[i].start, _original.get() + regions[i].start, regions[i].end - regions[i].start);
 	}
+
+	initFreeSpace(vanilla);
 }
 
-void Rom::writeUncompressed(wxVector<wxByte> &output, int index, int length, wxByte *paletteBuffer) {
-	writeChunkHeader(output, 0b000, length);
-	for (int i = 0; i < length; i++) {
-		output.push_back(paletteBuffer[index + i]);
+void Rom::addFreeSpace(uint64_t start, uint64_t end) {
+	// Data can't cross a bank boundary, so a region that does gets split into one region per bank
+	while (start < end) {
+		uint64_t bankEnd = std::min<uint64_t>((start | (kLoRomBankSize - 1)) + 1, end);
+		_freeSpace.push_back({start, bankEnd});
+		start = bankEnd;
 	}
 }
 
-void Rom::writeByteFill(wxVector<wxByte> &output, wxByte b, int length) {
-	writeChunkHeader(output, 0b001, length);
-	output.push_back(b);
-}
+long Rom::allocate(size_t length) {
+	// Best fit, so the smallest region that still has room for it
+	int best = -1;
+	for (size_t i = 0; i < _freeSpace.size(); i++) {
+		uint64_t size = _freeSpace[i].end - _freeSpace[i].start;
+		if ((size >= length) && ((best < 0) || (size < (_freeSpace[best].end - _freeSpace[best].start)))) {
+			best = i;
+		}
+	}
 
-void Rom::writeWordFill(wxVector<wxByte> &output, wxByte b1, wxByte b2, int length) {
-	writeChunkHeader(output, 0b010, length);
-	output.push_back(b1);
-	output.push_back(b2);
-}
+	if (best < 0) {
+		TRACE_LOG(kLogWarning, "out of free space! Can't fit " << length << " bytes");
+		return -1;
+	}
 
-void Rom::writeByteIncrement(wxVector<wxByte> &output, wxByte b, int length) {
-	writeChunkHeader(output, 0b011, length);
-	output.push_back(b);
+	// We take it from the start of the region, and drop the region if there's nothing left of it
+	long offset = _freeSpace[best].start;
+	_freeSpace[best].start += length;
+	if (_freeSpace[best].start == _freeSpace[best].end) {
+		_freeSpace.erase(_freeSpace.begin() + best);
+	}
+	return offset;
 }
 
-void Rom::writeCopy(wxVector<wxByte> &output, int address, int length) {
-	writeChunkHeader(output, 0b100, length);
-	output.push_back((wxByte) (address & 0xFF));
-	output.push_back((wxByte) (address >> 8));
+uint32_t Rom::pcToSnes(uint64_t offset) {
+	// LoRom maps each 0x8000 bytes of the file to the upper half of a bank
+	return ((offset << 1) & 0x7F0000) | (offset & 0x7FFF) | 0x8000;
 }
 
-void Rom::writeXorCopy(wxVector<wxByte> &output, int negOffset, int length) {
-	writeChunkHeader(output, 0b101, length);
-	output.push_back((wxByte) negOffset);
+uint64_t Rom::snesToPc(uint32_t address) {
+	// And the other way, the bank (without the fast rom bit) picks which 0x8000 bytes of the file
+	return ((address & 0x7F0000) >> 1) | (address & 0x7FFF);
 }
 
-void Rom::writeNegativeCopy(wxVector<wxByte> &output, int address, int length) {
-	writeChunkHeader(output, 0b110, length);
-	output.push_back((wxByte) address);
+enum paletteSizes {
+	kPalSize = kPaletteColours,
+	kPalBytes = 256,
+	kPalSlotSize = 0x200
+};
+
+bool Rom::decompress(uint64_t offset, std::vector<uint8_t> &output) {
+	if (offset >= _length) {
+		TRACE_LOG(kLogError, "invalid offset! Can't decompress from offset " << offset);
+		return false;
+	}
+
+	// The compressed data can't run past the end of the rom, so that's all the input we give it
+	if (lz5Decompress(_dataBuffer + offset, _length - offset, output) == false) {
+		TRACE_LOG(kLogError, "compressed data at offset is malformed " << offset);
+		return false;
+	}
+	return true;
 }
 
-void Rom::writeNegativeXorCopy(wxVector<wxByte> &output, int negOffset, int length) {
-	writeChunkHeader(output, 0b111, length);
-	output.push_back((wxByte) negOffset);
+std::vector<uint8_t> Rom::compress(const uint8_t *data, size_t length, int window) {
+	std::vector<uint8_t> output;
+	lz5Compress(data, length, output, window);
+	return output;
 }
 
-void Rom::calcByteFill(int *byteFillLengths, wxByte *paletteBuffer) {
-	int carry = 0;
-	for (int i = 0; i < kPalBytes; i++) {
-		if (carry == 0) {
-			wxByte value = paletteBuffer[i];
-			while (((i + carry) < kPalBytes) && (paletteBuffer[i + carry] == value)) {
-				carry++;
-			}
-		}
-		byteFillLengths[i] = carry;
-		carry--;
+void Rom::decompressPalette(Rgb *palette, uint64_t offset) {
+	std::vector<uint8_t> output;
+	if (decompress(offset, output) == false) {
+		return;
 	}
-}
 
-void Rom::calcWordFill(int *wordFillLengths, wxByte *paletteBuffer) {
-	int carry = 1;
-	for (int i = 0; i < kPalBytes - 1; i++) {
-		if (carry == 1) {
-			wxByte value[2] = {paletteBuffer[i], paletteBuffer[i + 1]};
-			while (((i + carry) < kPalBytes) && (paletteBuffer[i + carry] == value[carry & 1])) {
-				carry++;
-			}
-		}
-		wordFillLengths[i] = carry;
-		carry--;
+	// A palette is 128 colours, anything past that isn't ours to convert
+	int size = std::min<int>(output.size(), kPalBytes) & ~1;
+	for (int i = 0; i < size; i += 2) {
+		// Convert the colour to 24bit
+		palette[i / 2] = rgbFrom15(output[i] | (output[i + 1] << 8));
+	}
+
+	// And if the palette was short, the rest of it is black
+	for (int i = size / 2; i < kPalSize; i++) {
+		palette[i] = kRgbBlack;
 	}
 }
 
-void Rom::calcByteIncrement(int *byteIncrementLengths, wxByte *paletteBuffer) {
-	int carry = 0;
-	for (int i = 0; i < kPalBytes; i++) {
-		if (carry == 0) {
-			wxByte value = paletteBuffer[i];
-			while (((i + carry) < kPalBytes) && (paletteBuffer[i + carry] == value)) {
-				carry++;
-				value++;
-			}
-		}
-		byteIncrementLengths[i] = carry;
-		carry--;
+void Rom::packPalette(const Rgb *palette, wxByte *buffer) {
+	for (int i = 0; i < kPalSize; i++) {
+		// Convert the colour to 15bit, and store it across 2 bytes
+		uint16_t colour = colourTo15(palette[i]);
+		buffer[i * 2] = colour & 0x00FF;
+		buffer[(i * 2) + 1] = (colour & 0xFF00) >> 8;
 	}
 }
 
-void Rom::calcCopy(Interval *copyLengths, wxByte *paletteBuffer, int addresses[256][256], int *wordFillLengths, int *byteFillLengths) {
-	int backReferences[kPalBytes];
-	wxVector<Interval> matchLengths;
+bool Rom::compressPalette(const Rgb *palette, uint64_t offset) {
+	// We start by turning the array of 24bit colours into a byte buffer of 15bit colours
+	wxByte paletteBuffer[kPalBytes];
+	packPalette(palette, paletteBuffer);
 
-	for (int i = 0; i < 256; i++) {
-		for (int j = 0; j < 256; j++) {
-			addresses[i][j] = -1;
-		}
-	}
+	// Next we actually compress the data into an output stream, which we then write into the rom at offset
+	std::vector<uint8_t> output = compress(paletteBuffer, kPalBytes);
 
-	int byte1 = 0;
-	int byte2 = 0;
+	if (output.size() < kPalSlotSize) {
+		setBytes(offset, output.data(), output.size());
+		return true;
 
-	for (int i = 0; i < kPalBytes - 1;) {
-		int fillLength = wordFillLengths[i];
-		if (fillLength % 2 == 0) {
-			byte1 = paletteBuffer[i];
-			byte2 = paletteBuffer[i + 1];
-		
-		} else {
-			byte1 = paletteBuffer[i + 1];
-			byte2 = paletteBuffer[i];
-		}
+	} else {
+		TRACE_LOG(kLogWarning, "palette is too large, not overwriting");
+		return false;
+	}
+}
 
-		backReferences[i] = addresses[byte1][byte2];
-		addresses[byte1][byte2] = i;
+// FNV-1a, which is plenty for telling 256 byte palettes apart before comparing them properly
+static uint64_t hashPalette(const wxByte *buffer) {
+	uint64_t hash = 0xCBF29CE484222325;
+	for (int i = 0; i < kPalBytes; i++) {
+		hash = (hash ^ buffer[i]) * 0x100000001B3;
+	}
+	return hash;
+}
+
+int Rom::compressPalettes(Rgb *palettes[], uint64_t *offsets, int count, const std::atomic<bool> *cancel) {
+	TRACE_SCOPE("compressPalettes");
 
-		matchLengths.clear();
+	// Any palettes that come out identical share a single compressed copy
+	std::vector<std::array<wxByte, kPalBytes>> buffers;	// The distinct 15bit palettes
+	std::vector<int> owner(count, -1);					// Which of those each palette uses
+	std::unordered_map<uint64_t, std::vector<int>> seen;
 
-		int prevAddress = backReferences[i];
-		while (prevAddress >= 0) {
-			int prevFill = wordFillLengths[prevAddress];
-			int l = matchSubSequences(prevAddress + prevFill, i + fillLength, paletteBuffer, wordFillLengths, byteFillLengths);
-			matchLengths.push_back(Interval(prevAddress, l));
-			prevAddress = backReferences[prevAddress];
+	for (int i = 0; i < count; i++) {
+		offsets[i] = 0;
+		if (palettes[i] == nullptr) {
+			continue;
 		}
 
-		for (int j = 0; j < fillLength - 1; j++) {
-			Interval bestMatch = Interval(0, 0);
-			for (int n = 0; n < matchLengths.size(); n++) {
-				Interval match = Interval(0, 0);
-				int matchFill = wordFillLengths[matchLengths[n].Address];
-				if (matchFill < fillLength - j) {
-					match = Interval(0, 0);
-				
-				} else {
-					match = Interval(matchLengths[n].Address + matchFill - fillLength + j, matchLengths[n].Length + fillLength - j);
-				}
+		std::array<wxByte, kPalBytes> buffer;
+		packPalette(palettes[i], buffer.data());
 
-				if (match.Length > bestMatch.Length) {
-					bestMatch = match;
-				}
+		std::vector<int> &matches = seen[hashPalette(buffer.data())];
+		int index = buffers.size();
+		for (size_t j = 0; j < matches.size(); j++) {
+			if (buffers[matches[j]] == buffer) {
+				index = matches[j];
+				break;
 			}
-			copyLengths[i + j] = bestMatch;
 		}
 
-		addresses[byte1][byte2] = i;
-		i += fillLength - 1;
-	}
-}
-
-int Rom::matchSubSequences(int a, int b, wxByte *paletteBuffer, int *wordFillLengths, int *byteFillLengths) {
-	int bStart = b;
-
-	if ((b >= kPalBytes) || (paletteBuffer[a] != paletteBuffer[b])) {
-		return 0;
+		if (index == (int) buffers.size()) {
+			matches.push_back(index);
+			buffers.push_back(buffer);
+		}
+		owner[i] = index;
 	}
 
-	if (byteFillLengths[a] != byteFillLengths[b]) {
-		return (std::min(byteFillLengths[a], byteFillLengths[b]));
+	// Every palette compresses independently, so they get handed out to a few threads
+	std::vector<std::vector<uint8_t>> outputs(buffers.size());
+	parallelFor(buffers.size(), [&](size_t i) {
+		if ((cancel == nullptr) || (*cancel == false)) {
+			lz5Compress(buffers[i].data(), kPalBytes, outputs[i]);
+		}
+	});
+
+	// If the seed was cancelled partway through, none of it goes into the rom
+	if ((cancel != nullptr) && (*cancel == true)) {
+		int skipped = 0;
+		for (int i = 0; i < count; i++) {
+			if (owner[i] >= 0) {
+				skipped++;
+			}
+		}
+		return skipped;
 	}
 
-	if (((b + 1) >= kPalBytes) || (paletteBuffer[a + 1] != paletteBuffer[b + 1])) {
-		return 1;
+	// The rom itself only gets touched from here. Placing the biggest ones first leaves the small gaps for the small ones
+	std::vector<int> order(outputs.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
 	}
-
-	if (wordFillLengths[a] != wordFillLengths[b]) {
-		return (std::min(wordFillLengths[a], wordFillLengths[b]));
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return outputs[a].size() > outputs[b].size(); });
+
+	std::vector<long> placed(outputs.size(), -1);
+	for (size_t i = 0; i < order.size(); i++) {
+		int index = order[i];
+		placed[index] = allocate(outputs[index].size());
+		if (placed[index] >= 0) {
+			setBytes(placed[index], outputs[index].data(), outputs[index].size());
+		}
 	}
 
-	int step = std::max(byteFillLengths[a], wordFillLengths[a]);
-	a += step;
-	b += step;
-	while ((b < kPalBytes) && (paletteBuffer[a] == paletteBuffer[b])) {
-		a++;
-		b++;
+	// And then each palette gets the offset of whichever copy it shares
+	int failed = 0;
+	for (int i = 0; i < count; i++) {
+		if (owner[i] >= 0) {
+			if (placed[owner[i]] >= 0) {
+				offsets[i] = placed[owner[i]];
+			} else {
+				failed++;
+			}
+		}
 	}
-	return b - bStart;
+	return failed;
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
@@ -12,22 +12,34 @@
 #include <wx/wfstream.h>
 #include <wx/filename.h>
 
-struct Interval
-{
-    int Address;
-    int Length;
+#include <vector>
+#include <atomic>
+#include <memory>
 
-    Interval(int address, int length) : Address(address), Length(length) {}
-    Interval() {
-    	Address = 0;
-    	Length = 0;
-    }
+#include "compression.h"
+#include "colour.h"
 
-    void Reset()
-    {
-        Address = 0;
-        Length = 0;
-    }
+// A range of the rom that nothing is using, from start up to (not including) end
+struct FreeRegion {
+	uint64_t start;
+	uint64_t end;
+};
+
+// A run of bytes that got written to the rom, so that whatever made them can be put back without making it again
+struct RomWrite {
+	uint64_t offset;
+	std::vector<wxByte> bytes;
+};
+
+enum RomValues {
+	kLoRomBankSize = 0x8000		// Each bank maps 0x8000 bytes of the file
+};
+
+enum IPSValues {
+	kIPSHeaderSize	= 5,		// The offset and size in front of each record
+	kIPSMaxRecord	= 0xFFFF,
+	kIPSMaxOffset	= 0xFFFFFF,	// Offsets are only 3 bytes
+	kIPSOffsetEOF	= 0x454F46	// Which is "EOF", so no record can start there
 };
 
 /* Hexer Rom handler
@@ -37,39 +49,53 @@ struct Interval
 class Rom {
 public:
 	Rom(wxString path);
+	Rom(const Rom &base);									// Its own buffer, but the same bytes for the rom as it was loaded (which never change)
+	Rom &operator=(const Rom &) = delete;
 	~Rom() {
 		delete _rom;
-		delete _dataBuffer;
+		free(_dataBuffer);
 	}
 
 	wxFile *_rom;											// The Rom itself
-	wxByte *_dataBuffer;									// A mutable buffer of the rom data
+	wxByte *_dataBuffer = nullptr;							// A mutable buffer of the rom data
+	uint64_t _length = 0;									// How big the rom was when it was loaded (and so how big the buffers are)
 	wxString _name;											// The name of the rom file
+	std::vector<FreeRegion> _freeSpace;						// The regions of the rom still free for new data
+	std::vector<RomWrite> *_journal = nullptr;				// When this is set, every write to the buffer also gets added to it
 
+	bool isLoaded() const;									// Whether the file could be opened and read, nothing else works if it couldn't
 	void makeNewRom(wxString fileName);						// Creates a new rom from the data buffer
+	void revert();											// Puts the data buffer back to how the rom was when it was loaded
+	void replay(const std::vector<RomWrite> &writes);		// Writes everything in a journal back into the buffer
 	wxByte getByte(uint64_t offset);						// Gets a single byte from the rom at offset
 	void setByte(uint64_t offset, wxByte byte);				// Sets the byte at offset in the buffer to byte
 	void setWord(uint64_t offset, uint16_t word);			// Sets each byte of a word at a given offset in the buffer
+	void setLong(uint64_t offset, uint32_t value);			// Sets a 24bit long pointer at a given offset in the buffer
 	void setBytes(uint64_t offset, wxVector<wxByte> bytes);	// Sets the bytes at offset in the buffer to bytes
+	void setBytes(uint64_t offset, const wxByte *bytes, size_t length); // Copies length bytes into the buffer at offset
 	void applyPatch(wxByte *patch);							// Applies an ips patch supplied as a byte buffer to the rom buffer
-	void storeColour(uint64_t addr, wxColour clr);
+	std::vector<wxByte> makePatch();						// Makes an ips patch of everything in the buffer that's different from the rom as it was loaded
+	static std::vector<wxByte> diff(const wxByte *from, const wxByte *to, uint64_t length); // Makes an ips patch that turns from into to
+	void storeColour(uint64_t addr, const Rgb &clr);			// Stores a colour as 15bit at addr
+
+	void decompressPalette(Rgb *palette, uint64_t offset); // Decompresses a given 15bit palette into a 24 bit palette
+	bool compressPalette(const Rgb *palette, uint64_t offset);	// Compresses a given 24bit palette into the rom at a given address
+	int compressPalettes(Rgb *palettes[], uint64_t *offsets, int count, const std::atomic<bool> *cancel = nullptr); // Compresses a set of palettes into free space (nullptr entries are skipped), giving back where each went and returning how many didn't fit (all of them if cancelled)
+	static void packPalette(const Rgb *palette, wxByte *buffer);	// Converts a 128 colour 24bit palette into 256 bytes of 15bit colours
+	bool decompress(uint64_t offset, std::vector<uint8_t> &output);	// Decompresses any lz5 data at offset (gfx, tilemaps, level data, palettes)
+	void initFreeSpace(bool vanilla);						// Resets the free space to the known free regions of the PB or vanilla map layout
+	void revertFreeSpace(bool vanilla);						// Puts those regions back to how the rom was loaded, and makes them all free again
+	void addFreeSpace(uint64_t start, uint64_t end);		// Marks a region of the rom as free to use
+	long allocate(size_t length);							// Takes length bytes from the best fitting free region, returning the offset or -1 if nothing fits
+	static uint32_t pcToSnes(uint64_t offset);				// Converts a file offset into a LoRom address
+	static uint64_t snesToPc(uint32_t address);				// Converts a LoRom address into a file offset
+	std::vector<uint8_t> compress(const uint8_t *data, size_t length, int window = kLZ5DefaultWindow); // Compresses any buffer into lz5 data
+
+private:
+	std::shared_ptr<const wxByte> _original;				// The rom as it was loaded, shared by every copy of it
+	wxString _path;
 
-	void decompressPalette(wxColour *palette, uint64_t offset); // Decompresses a given 15bit palette into a 24 bit palette
-	bool compressPalette(wxColour *palette, uint64_t offset); 	// Compresses a given 24bit palette into the rom at a given address
-	void writeChunkHeader(wxVector<wxByte> &output, int type, int length);
-	void writeUncompressed(wxVector<wxByte> &output, int index, int length, wxByte *paletteBuffer);
-	void writeByteFill(wxVector<wxByte> &output, wxByte b, int length);
-	void writeWordFill(wxVector<wxByte> &output, wxByte b1, wxByte b2, int length);
-	void writeByteIncrement(wxVector<wxByte> &output, wxByte b, int length);
-	void writeCopy(wxVector<wxByte> &output, int address, int length);
-	void writeXorCopy(wxVector<wxByte> &output, int negOffset, int length);
-	void writeNegativeCopy(wxVector<wxByte> &output, int address, int length);
-	void writeNegativeXorCopy(wxVector<wxByte> &output, int negOffset, int length);
-	void calcByteFill(int *byteFillLengths, wxByte *paletteBuffer);
-	void calcWordFill(int *wordFillLengths, wxByte *paletteBuffer);
-	void calcByteIncrement(int *byteIncrementLengths, wxByte *paletteBuffer);
-	void calcCopy(Interval *copyLengths, wxByte *paletteBuffer, int addresses[256][256], int *wordFillLengths, int *byteFillLengths);
-	int matchSubSequences(int a, int b, wxByte *paletteBuffer, int *wordFillLengths, int *byteFillLengths);
+	void journal(uint64_t offset, size_t length);			// Adds a write that already happened to the journal (if there is one)
 };
 
 #endif
\ No newline at end of file
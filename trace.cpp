@@ -0,0 +1,122 @@
+#include "trace.h"
+
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+std::atomic<int> gLogLevel{kLogWarning};
+
+// Every thread's buffer, which only that thread writes to
+struct TraceBuffer {
+	int thread = 0;
+	bool inUse = false;
+	std::atomic<uint64_t> written{0};		// How many events have ever gone in, so the newest is at (written - 1) % size
+	TraceEvent events[kTraceBufferEvents];
+};
+
+static std::mutex gTraceMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> gTraceBuffers;
+static std::mutex gLogMutex;
+
+static const std::chrono::steady_clock::time_point gTraceStart = std::chrono::steady_clock::now();
+
+// A thread gives its buffer back when it ends, so all the threads parallelFor makes don't each need a new one
+struct TraceHolder {
+	TraceBuffer *buffer = nullptr;
+
+	~TraceHolder() {
+		if (buffer != nullptr) {
+			std::lock_guard<std::mutex> lock(gTraceMutex);
+			buffer->inUse = false;
+		}
+	}
+};
+
+static thread_local TraceHolder tTraceHolder;
+
+static TraceBuffer *threadBuffer() {
+	if (tTraceHolder.buffer != nullptr) {
+		return tTraceHolder.buffer;
+	}
+
+	std::lock_guard<std::mutex> lock(gTraceMutex);
+	for (std::unique_ptr<TraceBuffer> &buffer : gTraceBuffers) {
+		if (buffer->inUse == false) {
+			tTraceHolder.buffer = buffer.get();
+			break;
+		}
+	}
+
+	if (tTraceHolder.buffer == nullptr) {
+		// Whichever scope asked first didn't really make it
+#ifdef RANDO_ALLOC_TRACKING
+		int allocPrevious = allocEnter("trace buffers");
+#endif
+		gTraceBuffers.emplace_back(new TraceBuffer());
+#ifdef RANDO_ALLOC_TRACKING
+		allocLeave(allocPrevious);
+#endif
+		gTraceBuffers.back()->thread = gTraceBuffers.size();
+		tTraceHolder.buffer = gTraceBuffers.back().get();
+	}
+
+	tTraceHolder.buffer->inUse = true;
+	return tTraceHolder.buffer;
+}
+
+uint64_t traceNow() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - gTraceStart).count();
+}
+
+void traceEvent(const char *name, uint64_t start, uint64_t duration) {
+	TraceBuffer *buffer = threadBuffer();
+	uint64_t written = buffer->written.load(std::memory_order_relaxed);
+	buffer->events[written % kTraceBufferEvents] = {name, start, duration};
+	buffer->written.store(written + 1, std::memory_order_release);
+}
+
+void traceClear() {
+	std::lock_guard<std::mutex> lock(gTraceMutex);
+	for (std::unique_ptr<TraceBuffer> &buffer : gTraceBuffers) {
+		buffer->written = 0;
+	}
+}
+
+bool traceExport(const std::string &path) {
+	std::ofstream file(path);
+	if (file.is_open() == false) {
+		return false;
+	}
+
+	// Complete ('X') events, with the times in microseconds
+	file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+	bool first = true;
+
+	std::lock_guard<std::mutex> lock(gTraceMutex);
+	for (std::unique_ptr<TraceBuffer> &buffer : gTraceBuffers) {
+		uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t oldest = (written > kTraceBufferEvents) ? (written - kTraceBufferEvents) : 0;
+		for (uint64_t i = oldest; i < written; i++) {
+			const TraceEvent &event = buffer->events[i % kTraceBufferEvents];
+			file << ((first == true) ? "\n" : ",\n");
+			file << "{\"name\":\"" << event.name << "\",\"cat\":\"rando\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+				 << ",\"ts\":" << (event.start / 1000.0) << ",\"dur\":" << (event.duration / 1000.0) << "}";
+			first = false;
+		}
+	}
+
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return file.good();
+}
+
+void logLine(int level, const std::string &line) {
+	static const char *kLevelNames[] = {"error", "warning", "info", "debug"};
+
+	// No endl, so nothing waits on the console being flushed
+	std::lock_guard<std::mutex> lock(gLogMutex);
+	std::cout << kLevelNames[level] << ": " << line << '\n';
+}
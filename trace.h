@@ -0,0 +1,137 @@
+#ifndef RANDO_TRACE_H
+#define RANDO_TRACE_H
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <sstream>
+
+#include "alloc.h"
+
+/* Tracing
+ * Each part of making a seed can time itself with a TRACE_SCOPE, which
+ * adds an event (the name, when it started and how long it took) to a
+ * ring buffer that belongs to the thread it ran on. Only the most
+ * recent events are kept, and all of them can be saved as a Chrome
+ * trace (for chrome://tracing or ui.perfetto.dev).
+ *
+ * TRACE_PHASES and TRACE_PHASE do the same for a function made of
+ * steps one after another, where each step ends as the next starts.
+ *
+ * TRACE_LOG is for anything that used to just go to the console. It
+ * only builds the line if the log level is high enough, so the debug
+ * lines cost nothing unless someone asks for them.
+ *
+ * Building with -DRANDO_ALLOC_TRACKING also makes every scope and phase
+ * the one its allocations get put down to (see alloc.h).
+ *
+ * Building with -DRANDO_NO_TRACE takes out the scopes, and every log
+ * line below a warning.
+ */
+enum TraceValues {
+	kTraceBufferEvents = 8192		// How many events each thread keeps
+};
+
+enum LogLevel {
+	kLogError,
+	kLogWarning,
+	kLogInfo,
+	kLogDebug
+};
+
+// The name is always a string literal, so it never needs copying
+struct TraceEvent {
+	const char *name;
+	uint64_t start;					// Nanoseconds since the program started
+	uint64_t duration;
+};
+
+extern std::atomic<int> gLogLevel;
+
+uint64_t traceNow();
+void traceEvent(const char *name, uint64_t start, uint64_t duration);
+void traceClear();								// Throws away every event (only while nothing is being traced)
+bool traceExport(const std::string &path);		// Saves every event as Chrome trace JSON (only while nothing is being traced)
+void logLine(int level, const std::string &line);
+
+class TraceScope {
+public:
+	explicit TraceScope(const char *name) : _name(name), _start(traceNow()) {
+#ifdef RANDO_ALLOC_TRACKING
+		_allocPrevious = allocEnter(name);
+#endif
+	}
+
+	~TraceScope() {
+		traceEvent(_name, _start, traceNow() - _start);
+#ifdef RANDO_ALLOC_TRACKING
+		allocLeave(_allocPrevious);
+#endif
+	}
+
+private:
+	const char *_name;
+	uint64_t _start;
+#ifdef RANDO_ALLOC_TRACKING
+	int _allocPrevious = 0;
+#endif
+};
+
+// A run of phases one after another, where each one ends when the next begins (or when this goes out of scope)
+class TracePhases {
+public:
+	~TracePhases() {
+		end();
+	}
+
+	void begin(const char *name) {
+		end();
+		_name = name;
+		_start = traceNow();
+#ifdef RANDO_ALLOC_TRACKING
+		_allocPrevious = allocEnter(name);
+#endif
+	}
+
+	void end() {
+		if (_name != nullptr) {
+			traceEvent(_name, _start, traceNow() - _start);
+			_name = nullptr;
+#ifdef RANDO_ALLOC_TRACKING
+			allocLeave(_allocPrevious);
+#endif
+		}
+	}
+
+private:
+	const char *_name = nullptr;
+	uint64_t _start = 0;
+#ifdef RANDO_ALLOC_TRACKING
+	int _allocPrevious = 0;
+#endif
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifndef RANDO_NO_TRACE
+	#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+	#define TRACE_PHASES(phases) TracePhases phases
+	#define TRACE_PHASE(phases, name) phases.begin(name)
+	#define TRACE_ENABLED(level) ((level) <= gLogLevel.load(std::memory_order_relaxed))
+#else
+	#define TRACE_SCOPE(name) do {} while (0)
+	#define TRACE_PHASES(phases) do {} while (0)
+	#define TRACE_PHASE(phases, name) do {} while (0)
+	#define TRACE_ENABLED(level) (((level) <= kLogWarning) && ((level) <= gLogLevel.load(std::memory_order_relaxed)))
+#endif
+
+#define TRACE_LOG(level, message) do { \
+	if (TRACE_ENABLED(level)) { \
+		std::ostringstream traceLine; \
+		traceLine << message; \
+		logLine(level, traceLine.str()); \
+	} \
+} while (0)
+
+#endif